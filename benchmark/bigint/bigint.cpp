@@ -1,5 +1,6 @@
 #include <BigInt.hpp>
 #include <algo/bigint.hpp>
+#include <algo/bigint/divisor.hpp>
 #include <exception>
 
 #ifndef NCRYPTOPP
@@ -10,6 +11,18 @@
 
 #include <random>
 
+namespace algo {
+
+struct BigIntPeer {
+  template<std::size_t cap, typename W, typename DW>
+  static void KaratsubaMul(BigInt<cap, W, DW>& lhs,
+                           const BigInt<cap, W, DW>& rhs) noexcept {
+    lhs.KaratsubaUMulByRange(rhs.ToView());
+  }
+};
+
+} // namespace algo
+
 template<typename T>
 struct BigIntFactory {
   using Type = T;
@@ -92,14 +105,172 @@ static void BM_Fermat(benchmark::State& state) {
   }
 }
 
+template<typename BigInt>
+static BigInt RandomWords(std::size_t words, std::default_random_engine& e) {
+  using Word = std::remove_cvref_t<decltype(BigInt{}.binary[0])>;
+  std::uniform_int_distribution<Word> dist(1);
+  std::vector<Word> ret(words);
+  for (Word& w : ret) {
+    w = dist(e);
+  }
+  return BigInt{ret};
+}
+
+// Multiplication of two random numbers of state.range(0) words
+template<typename BigInt, bool karatsuba>
+static void BM_MulSweep(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt lhs = RandomWords<BigInt>(state.range(0), e);
+  BigInt rhs = RandomWords<BigInt>(state.range(0), e);
+
+  for (auto _ : state) {
+    BigInt mul = lhs;
+    if constexpr (karatsuba) {
+      algo::BigIntPeer::KaratsubaMul(mul, rhs);
+    } else {
+      mul *= rhs;
+    }
+    benchmark::DoNotOptimize(mul);
+  }
+}
+
+// Squaring of a random number of state.range(0) words
+template<typename BigInt>
+static void BM_SquareSweep(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt value = RandomWords<BigInt>(state.range(0), e);
+
+  for (auto _ : state) {
+    BigInt square = value;
+    square *= square;
+    benchmark::DoNotOptimize(square);
+  }
+}
+
+// Division of 2 * state.range(0) words by state.range(0) words
+template<typename BigInt>
+static void BM_DivSweep(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt lhs = RandomWords<BigInt>(2 * state.range(0), e);
+  BigInt rhs = RandomWords<BigInt>(state.range(0), e);
+
+  for (auto _ : state) {
+    BigInt div = lhs / rhs;
+    benchmark::DoNotOptimize(div);
+  }
+}
+
+// Division of state.range(0) words by state.range(1) words
+template<typename BigInt>
+static void BM_DivSkewed(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt lhs = RandomWords<BigInt>(state.range(0), e);
+  BigInt rhs = RandomWords<BigInt>(state.range(1), e);
+
+  for (auto _ : state) {
+    BigInt div = lhs / rhs;
+    benchmark::DoNotOptimize(div);
+  }
+}
+
+// Remainder of 2 * state.range(0) words by state.range(0) words, divisor is
+// either precomputed or not
+template<typename BigInt, bool precomputed>
+static void BM_ModSweep(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt lhs = RandomWords<BigInt>(2 * state.range(0), e);
+  BigInt rhs = RandomWords<BigInt>(state.range(0), e);
+  algo::BigIntDivisor divisor{rhs};
+
+  for (auto _ : state) {
+    BigInt mod = precomputed ? divisor.Mod(lhs) : lhs % rhs;
+    benchmark::DoNotOptimize(mod);
+  }
+}
+
+// String in base of random number of state.range(0) words
+template<typename BigInt, int base>
+static void BM_ToStringSweep(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt value = RandomWords<BigInt>(state.range(0), e);
+
+  for (auto _ : state) {
+    std::string str = value.ToString(base);
+    benchmark::DoNotOptimize(str);
+  }
+}
+
+// Multiplication of state.range(0) words by state.range(1) words
+template<typename BigInt>
+static void BM_MulSkewed(benchmark::State& state) {
+  std::default_random_engine e{0};
+  BigInt lhs = RandomWords<BigInt>(state.range(0), e);
+  BigInt rhs = RandomWords<BigInt>(state.range(1), e);
+
+  for (auto _ : state) {
+    BigInt mul = lhs * rhs;
+    benchmark::DoNotOptimize(mul);
+  }
+}
+
 #ifndef NCRYPTOPP
 BENCHMARK(BM_Fermat<BigIntFactory<CryptoPP::Integer>>); // CryptoPP
 BENCHMARK(BM_LongMul<BigIntFactory<CryptoPP::Integer>>);
 #endif
 
 BENCHMARK(BM_LongMul<BigIntFactory<algo::BigInt<2100>>>);
+BENCHMARK(BM_LongMul<
+          BigIntFactory<algo::BigInt<1050, uint64_t, algo::Uint128>>>);
+
+BENCHMARK(BM_MulSweep<algo::BigInt<8200>, false>)
+    ->RangeMultiplier(2)
+    ->Range(32, 4096);
+BENCHMARK(BM_MulSweep<algo::BigInt<8200>, true>)
+    ->RangeMultiplier(2)
+    ->Range(32, 4096);
+
+BENCHMARK(BM_SquareSweep<algo::BigInt<8200>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 4096);
+BENCHMARK(BM_MulSweep<algo::BigInt<8200>, false>)
+    ->RangeMultiplier(2)
+    ->Range(2, 16);
+
+BENCHMARK(BM_DivSweep<algo::BigInt<4200>>)
+    ->RangeMultiplier(4)
+    ->Range(2, 2048);
+
+BENCHMARK(BM_DivSkewed<algo::BigInt<16400>>)
+    ->Args({16000, 500})
+    ->Args({16000, 1000})
+    ->Args({16000, 2000})
+    ->Args({16000, 8000});
+
+BENCHMARK(BM_ModSweep<algo::BigInt<4200>, false>)
+    ->RangeMultiplier(4)
+    ->Range(1, 2048);
+BENCHMARK(BM_ModSweep<algo::BigInt<4200>, true>)
+    ->RangeMultiplier(4)
+    ->Range(1, 2048);
+
+BENCHMARK(BM_ToStringSweep<algo::BigInt<16400>, 10>)
+    ->RangeMultiplier(4)
+    ->Range(16, 16384);
+BENCHMARK(BM_ToStringSweep<algo::BigInt<16400>, 16>)
+    ->RangeMultiplier(4)
+    ->Range(16, 16384);
+
+BENCHMARK(BM_MulSkewed<algo::BigInt<4200>>)
+    ->Args({2000, 40})
+    ->Args({2000, 100})
+    ->Args({2000, 200})
+    ->Args({2000, 700})
+    ->Args({2000, 1000})
+    ->Args({2000, 1400});
 
 BENCHMARK(BM_Fermat<BigIntFactory<algo::BigInt<8, uint8_t, uint16_t>>>);
 BENCHMARK(BM_Fermat<BigIntFactory<algo::BigInt<2, uint32_t, uint64_t>>>);
+BENCHMARK(
+    BM_Fermat<BigIntFactory<algo::BigInt<1, uint64_t, algo::Uint128>>>);
 BENCHMARK(BM_Fermat<BigIntFactory<uint64_t>>);
 BENCHMARK(BM_Fermat<BigIntFactory<BigInt>>); // faheel bigint
@@ -1,25 +1,59 @@
 #pragma once
 
 #include <algo/assert.hpp>
+#include <algo/bigint/kernel.hpp>
+#include <algo/bigint/ntt.hpp>
+#include <algo/bigint/small_words.hpp>
 #include <algo/concepts.hpp>
+#include <algo/expected.hpp>
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cassert>
+#include <functional>
+#include <iterator>
 #include <limits>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace algo {
 
+/*
+ * Unsigned word types for BigInt. std::numeric_limits is not required to be
+ * specialized for extended integer types, so WordTraits may be specialized
+ * instead for a DoubleWord like unsigned __int128
+ */
+template<typename T>
+struct WordTraits {
+  static constexpr bool kIsUnsigned = std::numeric_limits<T>::is_specialized &&
+                                      !std::numeric_limits<T>::is_signed &&
+                                      std::numeric_limits<T>::is_modulo;
+  static constexpr std::size_t kDigits = std::numeric_limits<T>::digits;
+};
+
+#ifdef __SIZEOF_INT128__
+// BigInt<words_capacity, uint64_t, Uint128> has 64 bit words
+__extension__ using Uint128 = unsigned __int128;
+
+template<>
+struct WordTraits<Uint128> {
+  static constexpr bool kIsUnsigned = true;
+  static constexpr std::size_t kDigits = 128;
+};
+#endif
+
 template<std::size_t words_capacity, typename Word = uint32_t,
          typename DoubleWord = uint64_t>
 class BigInt {
-  static_assert(words_capacity > 0 && !std::numeric_limits<Word>::is_signed &&
-                std::numeric_limits<Word>::is_modulo &&
-                !std::numeric_limits<DoubleWord>::is_signed &&
-                std::numeric_limits<DoubleWord>::is_modulo);
+  static_assert(words_capacity > 0 && WordTraits<Word>::kIsUnsigned &&
+                WordTraits<DoubleWord>::kIsUnsigned);
 
-  static_assert(sizeof(DoubleWord) >= sizeof(Word) * 2,
+  static_assert(WordTraits<DoubleWord>::kDigits >=
+                    2 * WordTraits<Word>::kDigits,
                 "DoubleWord should be able to hold "
                 "result of any Word multiplication");
 
@@ -35,6 +69,47 @@ class BigInt {
 
   static constexpr Word kMaxWord = std::numeric_limits<Word>::max();
 
+  using Kernel = detail::BigIntKernel<Word, DoubleWord>;
+
+  // Capacity of temporaries holding a product, InfInt ones grow as well
+  static constexpr std::size_t kDoubleCapacity =
+      kInfInt ? words_capacity : 2 * words_capacity;
+  // Capacity, which fits any product by BigInt<rhs_cap>
+  template<std::size_t rhs_cap>
+  static constexpr std::size_t kProductCapacity =
+      kInfInt || rhs_cap == std::numeric_limits<std::size_t>::max()
+          ? std::numeric_limits<std::size_t>::max()
+          : words_capacity + rhs_cap;
+
+  // Minimal words count of the longest operand for Toom-Cook multiplication
+  static constexpr std::size_t kToom3Threshold = 200;
+  static constexpr std::size_t kToom4Threshold = 400;
+
+  // Both operands should have at least this many words to be multiplied
+  // via number theoretic transform. Transform cost depends on bit length
+  // only, while Toom-Cook gets twice faster per bit on 64 bit words
+  static constexpr std::size_t kNttThreshold = kWordBSize >= 64 ? 1024 : 256;
+
+  // Both quotient and divisor should have at least this many words to be
+  // divided by Burnikel-Ziegler recursion
+  static constexpr std::size_t kBurnikelThreshold = 400;
+
+  // Minimal divisor words count for division via Newton reciprocal. It is
+  // chosen only for quotients at least 4 times longer than divisor, so that
+  // reciprocal is reused by several blocks of quotient
+  static constexpr std::size_t kNewtonThreshold = 1000;
+
+  // Both quotient and divisor should have at least this many words for
+  // exact division to be split into halves
+  static constexpr std::size_t kHenselThreshold = 2000;
+
+  // Minimal words count for number to be converted to string by splitting it
+  // with division by power of base
+  static constexpr std::size_t kToStringThreshold = 200;
+
+  // Minimal chunks count for digits to be parsed by halves
+  static constexpr std::size_t kFromStringThreshold = 1000;
+
 public:
   constexpr BigInt() noexcept;
   constexpr BigInt(const BigInt&) noexcept;
@@ -46,6 +121,16 @@ public:
   constexpr BigInt(uint64_t integer, bool is_positive = true) noexcept;
   constexpr BigInt(std::string_view str) noexcept;
 
+  // Number is optionally signed, prefixes 0b, 0o and 0x stand for binary,
+  // octal and hexadecimal, letters are case insensitive. Digits may be
+  // separated by '. Fails on malformed input or if number doesn't fit
+  static Expected<BigInt> FromString(std::string_view str) noexcept;
+  // Same, words and scratch of parsing come from resource
+  static Expected<BigInt>
+  FromString(std::string_view str,
+             std::pmr::memory_resource& resource) noexcept
+    requires(kInfInt);
+
   constexpr BigInt(const Range<Word> auto& range,
                    bool is_positive = true) noexcept;
 
@@ -65,6 +150,41 @@ public:
   constexpr BigInt& operator/=(const BigInt&) noexcept;
   constexpr BigInt& operator%=(const BigInt&) noexcept;
 
+  // Operands of other capacities are read in place, result should fit in
+  // capacity of this
+  template<std::size_t rhs_cap>
+    requires(rhs_cap != words_capacity)
+  constexpr BigInt&
+  operator+=(const BigInt<rhs_cap, Word, DoubleWord>& rhs) noexcept;
+  template<std::size_t rhs_cap>
+    requires(rhs_cap != words_capacity)
+  constexpr BigInt&
+  operator-=(const BigInt<rhs_cap, Word, DoubleWord>& rhs) noexcept;
+  template<std::size_t rhs_cap>
+    requires(rhs_cap != words_capacity)
+  constexpr BigInt&
+  operator%=(const BigInt<rhs_cap, Word, DoubleWord>& rhs) noexcept;
+
+  // this /= rhs, where rhs is known to divide this. Quotient is built from
+  // the lowest words by 2-adic inverse of rhs, so no quotient estimation
+  // is needed. Exactness is asserted in debug build
+  constexpr BigInt& DivExact(const BigInt& rhs) noexcept;
+
+  // this *= this, also chosen by operator*= when rhs is *this
+  constexpr BigInt& Square() noexcept;
+
+  // Lazy sums of products of algo/bigint/lazy.hpp are computed right into
+  // this, reusing its words
+  template<typename Lazy>
+    requires requires(const Lazy& expr, BigInt& acc) { expr.AddTo(acc); }
+  constexpr BigInt& operator=(const Lazy& expr) noexcept;
+  template<typename Lazy>
+    requires requires(const Lazy& expr, BigInt& acc) { expr.AddTo(acc); }
+  constexpr BigInt& operator+=(const Lazy& expr) noexcept;
+  template<typename Lazy>
+    requires requires(const Lazy& expr, BigInt& acc) { expr.AddTo(acc); }
+  constexpr BigInt& operator-=(const Lazy& expr) noexcept;
+
   constexpr BigInt operator~() const noexcept;
   constexpr BigInt& operator^=(const BigInt&) noexcept;
   constexpr BigInt& operator&=(const BigInt&) noexcept;
@@ -77,16 +197,78 @@ public:
   constexpr uint64_t ToUint() const noexcept;
   constexpr auto ToView() const noexcept;
 
+  // Words count this can hold. InfInt grows on demand, room may be reserved
+  // ahead of time and unused one released. Other capacities are fixed
+  constexpr std::size_t Capacity() const noexcept;
+  constexpr void Reserve(std::size_t words) noexcept;
+  constexpr void ShrinkToFit() noexcept;
+
+  // InfInt words and scratch of its operations come from resource, e.g. an
+  // arena released at once. Like copies of std::pmr containers, copy
+  // construction doesn't keep resource, so the copy outlives the arena.
+  // BigInt{other, resource} copies into resource, assignment keeps the one
+  // of destination and results of free operators get the one of lhs.
+  // Resource() is null for std::allocator and for fixed capacities
+  constexpr explicit BigInt(std::pmr::memory_resource& resource) noexcept
+    requires(kInfInt);
+  constexpr BigInt(const BigInt& other,
+                   std::pmr::memory_resource& resource) noexcept
+    requires(kInfInt);
+  constexpr std::pmr::memory_resource* Resource() const noexcept;
+
   friend std::ostream& operator<<(std::ostream& os, const BigInt& bi) {
     os << bi.ToString();
     return os;
   }
 
-  std::conditional_t<kInfInt, // TODO add support for vector
-                     std::vector<Word>, std::array<Word, words_capacity>>
+  // {lhs / rhs, lhs % rhs} computed by a single division
+  friend constexpr std::pair<BigInt, BigInt>
+  DivMod(const BigInt& lhs, const BigInt& rhs) noexcept {
+    std::pair<BigInt, BigInt> ret{BigInt{lhs.ScratchAllocator()},
+                                  BigInt{lhs.ScratchAllocator()}};
+    lhs.DivModInner(rhs, &ret.first, &ret.second);
+    return ret;
+  }
+
+  // lhs * rhs in capacity, which fits any product of them, e.g. before
+  // reduction by modulo. Neither operand is copied into the wider BigInt
+  template<std::size_t rhs_cap>
+  friend constexpr BigInt<kProductCapacity<rhs_cap>, Word, DoubleWord>
+  MulWide(const BigInt& lhs,
+          const BigInt<rhs_cap, Word, DoubleWord>& rhs) noexcept {
+    BigInt<kProductCapacity<rhs_cap>, Word, DoubleWord> ret;
+    UMulInto(ret, lhs.ToView(), rhs.ToView());
+    ret.is_positive = lhs.is_positive == rhs.is_positive || ret.IsZero();
+    return ret;
+  }
+
+  // acc += x * y (acc -= x * y). Products of operands shorter than
+  // Karatsuba threshold are accumulated right into words of acc
+  friend constexpr void AddMul(BigInt& acc, const BigInt& x,
+                               const BigInt& y) noexcept {
+    acc.AddProduct(x, y, true);
+  }
+  friend constexpr void SubMul(BigInt& acc, const BigInt& x,
+                               const BigInt& y) noexcept {
+    acc.AddProduct(x, y, false);
+  }
+  // acc += x * word (acc -= x * word)
+  friend constexpr void AddMulWord(BigInt& acc, const BigInt& x,
+                                   Word word) noexcept {
+    acc.AddWordProduct(x, word, true);
+  }
+  friend constexpr void SubMulWord(BigInt& acc, const BigInt& x,
+                                   Word word) noexcept {
+    acc.AddWordProduct(x, word, false);
+  }
+
+  std::conditional_t<kInfInt, detail::SmallWords<Word>,
+                     std::array<Word, words_capacity>>
       binary; // number is storred right to left, e.g. most significant bits
               // are at the end of an array
               // can't use bitset here, because not constexpr (since C++23)
+              // InfInt words may be shared by copies, non-const access
+              // copies them first, see detail::SmallWords
   std::size_t words_count;
   bool is_positive;
 
@@ -94,6 +276,41 @@ private:
   template<std::size_t s, typename W, typename DW>
   friend class BigInt;
 
+  template<std::size_t s, typename W, typename DW>
+  friend class BigIntDivisor;
+
+  // Gives tests and benchmarks access to particular algorithms
+  friend struct BigIntPeer;
+
+  // Scratch words allocated like the ones of this
+  using Scratch = std::vector<Word, detail::ResourceAllocator<Word>>;
+  constexpr detail::ResourceAllocator<Word> ScratchAllocator() const noexcept;
+
+  // Temporaries of InfInt operations are allocated like their operands,
+  // static functions below take allocator for them. Fixed capacities ignore
+  // allocator
+  constexpr explicit BigInt(detail::ResourceAllocator<Word> allocator) noexcept;
+  constexpr BigInt(const BigInt& other,
+                   detail::ResourceAllocator<Word> allocator) noexcept;
+  constexpr BigInt(const Range<Word> auto& range,
+                   detail::ResourceAllocator<Word> allocator) noexcept;
+  template<std::size_t n>
+  static constexpr std::array<BigInt, n>
+  Zeros(detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // Makes binary hold at least words words, InfInt grows at least twice.
+  // Words shared with copies of InfInt are copied, so it's called before
+  // any write to binary. Fixed capacity is checked by callers
+  constexpr void Grow(std::size_t words) noexcept;
+  // Same for range, which may point to binary. Range is moved to the
+  // replaced buffer, which is returned to be kept by caller
+  constexpr detail::SmallWords<Word>
+  Grow(std::size_t words, std::span<const Word>& range) noexcept;
+  // Unconditional reallocation of InfInt, the replaced buffer is moved to
+  // old if it's given
+  constexpr void Reallocate(std::size_t words,
+                            detail::SmallWords<Word>* old = nullptr) noexcept;
+
   // All operations below can work properly if
   // range points to subrange of this->binary
   static constexpr bool
@@ -106,31 +323,229 @@ private:
 
   constexpr void
   UResetBinary(const RandomAccessRange<Word> auto& range) noexcept;
-  constexpr void UAddRange(const RandomAccessRange<Word> auto& range) noexcept;
+
+  // Numbers of at most two words are handled as DoubleWord by fast paths,
+  // e.g. counters. Sum is made of value and carry to the third word
+  constexpr DoubleWord UDoubleWord() const noexcept;
+  constexpr void UResetDoubleWord(DoubleWord value,
+                                  bool carry = false) noexcept;
+  // this += rhs for rhs with given sign and absolute value
+  constexpr void ShortAdd(DoubleWord rhs, bool rhs_is_positive) noexcept;
+  // this += rhs (this -= rhs if !positive) for rhs of any capacity
+  template<std::size_t rhs_cap>
+  constexpr void AddSigned(const BigInt<rhs_cap, Word, DoubleWord>& rhs,
+                           bool positive) noexcept;
+  // range is added starting from offset-th word of this
+  constexpr void UAddRange(std::span<const Word> range,
+                           std::size_t offset = 0) noexcept;
 
   // subtract by range and return if sign changes
-  constexpr bool USubRange(const RandomAccessRange<Word> auto& range) noexcept;
+  constexpr bool USubRange(std::span<const Word> range) noexcept;
 
   // Multiplication
   // either this or rhs is lesser than Word
-  constexpr void
-  UMulByShortRange(const RandomAccessRange<Word> auto& range) noexcept;
+  constexpr void UMulByShortRange(std::span<const Word> range) noexcept;
 
-  template<std::size_t subint_words_capacity>
   constexpr void
   KaratsubaUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
 
+  // Operands are split into this_parts and range_parts parts, the product
+  // is evaluated in points 0, 1, -1, inf (4 points), 0, 1, -1, 2, inf
+  // (5 points) or 0, 1, -1, 2, -2, 1/2, inf (7 points)
+  template<std::size_t this_parts, std::size_t range_parts>
+  constexpr void
+  ToomUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
+
+  // Values of polynomial with coefficients of part words taken from range
+  template<std::size_t parts, std::size_t points>
+  static constexpr std::array<BigInt, points>
+  ToomEvaluate(const RandomAccessRange<Word> auto& range, std::size_t part,
+               detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // Restores product from its values and writes it into this
+  template<std::size_t points>
+  constexpr void ToomInterpolate(const std::array<BigInt, points>& values,
+                                 std::size_t part) noexcept;
+
+  // Long operand is cut into blocks of the short operand size
+  constexpr void
+  UnbalancedUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
+
+  // Picks Karatsuba or Toom-Cook by operand sizes
+  constexpr void
+  BalancedUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
+
+  constexpr void
+  SplitUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
+
+  constexpr void
+  NttUMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
+
   constexpr void
   UMulByRange(const RandomAccessRange<Word> auto& range) noexcept;
 
+  // |ret| = lhs * rhs, ret should fit the product
+  template<std::size_t ret_cap>
+  static constexpr void UMulInto(BigInt<ret_cap, Word, DoubleWord>& ret,
+                                 std::span<const Word> lhs,
+                                 std::span<const Word> rhs) noexcept;
+
+  // this += x * y (this -= x * y if !positive). Products of long operands
+  // or of this are computed aside
+  constexpr void AddProduct(const BigInt& x, const BigInt& y,
+                            bool positive) noexcept;
+  constexpr void AddWordProduct(const BigInt& x, Word word,
+                                bool positive) noexcept;
+  // this += lhs * rhs (this -= lhs * rhs if !product_is_positive) row by
+  // row, product should fit in cap
+  constexpr void AddMulRows(std::span<const Word> lhs,
+                            std::span<const Word> rhs,
+                            bool product_is_positive) noexcept;
+
+  // Calls f.template operator()<small_cap>() for the least small_cap = 2^k,
+  // which is at least size, or for max_cap. Algorithms above work with
+  // temporaries of their own capacity, so the ones of BigInt<small_cap> are
+  // shared by every capacity with the same Word
+  template<std::size_t max_cap, std::size_t small_cap = 64>
+  static constexpr decltype(auto) WithCapacity(std::size_t size,
+                                               auto&& f) noexcept;
+
+  // Squaring, a_i * a_j products are computed only once
+  constexpr void BasecaseUSquare() noexcept;
+
+  constexpr void KaratsubaUSquare() noexcept;
+
+  template<std::size_t parts>
+  constexpr void ToomUSquare() noexcept;
+
+  constexpr void BalancedUSquare() noexcept;
+
+  constexpr void NttUSquare() noexcept;
+
+  constexpr void USquare() noexcept;
+
   // Division
   constexpr Word UDivByWord(Word rhs) noexcept; // returns remainder
-  // result of division will fit into Word type
-  constexpr BigInt
-  UDivBySameRange(const RandomAccessRange<Word> auto& range) noexcept;
-  // returns remainder
-  constexpr BigInt
-  UDivByRange(const RandomAccessRange<Word> auto& range) noexcept;
+  constexpr Word UModByWord(Word rhs) const noexcept;
+  // Same for rhs given as d = rhs << shift and v = Kernel::Reciprocal(d)
+  constexpr Word UDivByWord(Word d, Word v, int shift) noexcept;
+  constexpr Word UModByWord(Word d, Word v, int shift) const noexcept;
+
+  // Functions below divide u by v with the same contract as
+  // Kernel::KnuthDivide
+  // Burnikel-Ziegler recursion: quotient is split into halves, every half is
+  // estimated by division by the top half of v and corrected by
+  // multiplication. Every divisor there is top words of v, so base cases
+  // share v_inv = Kernel::Reciprocal(v.back())
+  static constexpr void
+  BurnikelDivide(std::span<Word> u, std::span<const Word> v, Word v_inv,
+                 std::span<Word> q,
+                 detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // Barrett reduction by blocks of v.size() words with inv =
+  // NewtonReciprocal(v), words capacity should be at least 2n
+  static constexpr void
+  NewtonDivide(std::span<Word> u, std::span<const Word> v,
+               std::span<const Word> inv, std::span<Word> q,
+               detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // floor((B^2n - 1) / v) - B^n for B = 2^kWordBSize and n = v.size(),
+  // words capacity should be at least 2n
+  static constexpr Scratch
+  NewtonReciprocal(std::span<const Word> v,
+                   detail::ResourceAllocator<Word> allocator) noexcept;
+
+  static constexpr void
+  Divide(std::span<Word> u, std::span<const Word> v, std::span<Word> q,
+         detail::ResourceAllocator<Word> allocator) noexcept;
+  // Same with v_inv = Kernel::Reciprocal(v.back()) given
+  static constexpr void
+  Divide(std::span<Word> u, std::span<const Word> v, Word v_inv,
+         std::span<Word> q,
+         detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // NewtonReciprocal and NewtonDivide with capacity of temporaries picked by
+  // v.size(), used when reciprocal is reused by several divisions
+  static constexpr Scratch
+  DivisorReciprocal(std::span<const Word> v,
+                    detail::ResourceAllocator<Word> allocator) noexcept;
+  static constexpr void
+  DivideByReciprocal(std::span<Word> u, std::span<const Word> v,
+                     std::span<const Word> inv, std::span<Word> q,
+                     detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // Quotient and remainder are written into corresponding arguments, unless
+  // they are null. Only one of them may point to this
+  constexpr void
+  UDivModByRange(const RandomAccessRange<Word> auto& range, BigInt* quotient,
+                 BigInt* remainder) const noexcept;
+  template<std::size_t rhs_cap>
+  constexpr void DivModInner(const BigInt<rhs_cap, Word, DoubleWord>& rhs,
+                             BigInt* quotient,
+                             BigInt* remainder) const noexcept;
+  // Jebelean's exact division of u by odd d modulo B^u.size() with
+  // d_inv = Kernel::InverseModB(d[0]), quotient replaces u. Lowest half of
+  // quotient depends only on the lowest half of u, so u is divided by halves
+  static constexpr void
+  HenselDivide(std::span<Word> u, std::span<const Word> d, Word d_inv,
+               detail::ResourceAllocator<Word> allocator) noexcept;
+  // u[k ..] -= q d / B^k modulo B^(u.size() - k) for q = u[0 .. k)
+  static constexpr void
+  HenselSubProduct(std::span<Word> u, std::size_t k, std::span<const Word> d,
+                   detail::ResourceAllocator<Word> allocator) noexcept;
+
+  // range should divide this
+  constexpr void
+  UDivExactByRange(const RandomAccessRange<Word> auto& range) noexcept;
+  // Division by v = vn >> shift, where vn is normalized and at least two
+  // words long, this should be greater than v. Quotient words are computed
+  // by divide(u, vn, q) with the same contract as Kernel::KnuthDivide
+  constexpr void UDivModByNormalized(std::span<const Word> vn, int shift,
+                                     BigInt* quotient, BigInt* remainder,
+                                     auto&& divide) const noexcept;
+
+  // Appends digits of this in base to str, where powers[i] is chunk^(2^i)
+  // and chunk is base^chunk_digits. Number is padded with zeros to digits
+  // count, if it is not zero
+  constexpr void AppendDigits(std::string& str, Word base,
+                              std::size_t chunk_digits,
+                              std::span<const BigInt> powers,
+                              std::size_t level,
+                              std::size_t digits) const noexcept;
+
+  // Bits [pos, pos + len) of absolute value, len should be at most 32
+  constexpr uint64_t BitsAt(std::size_t pos, std::size_t len) const noexcept;
+  // Appends digits of this in base 2^bits, which are sliced from binary
+  constexpr void AppendPowerOf2Digits(std::string& str,
+                                      int bits) const noexcept;
+
+  // Parsing
+  // Value of char as a digit, not less than 36 if char is not a digit
+  static constexpr std::array<uint8_t, 256> kDigitValues = [] {
+    std::array<uint8_t, 256> ret;
+    ret.fill(36);
+    for (uint8_t i = 0; i < 10; ++i) {
+      ret['0' + i] = i;
+    }
+    for (uint8_t i = 0; i < 26; ++i) {
+      ret['A' + i] = ret['a' + i] = 10 + i;
+    }
+    return ret;
+  }();
+  // Checks that every char is a digit in base
+  static constexpr bool AreDigits(std::string_view str, Word base) noexcept;
+  // Value of digits, which should fit into uint64_t
+  static constexpr uint64_t ChunkValue(std::string_view digits,
+                                       Word base) noexcept;
+  // this = digits in base, where powers[i] is chunk^(2^i) and chunk is
+  // base^chunk_digits. Long numbers are parsed by halves
+  constexpr void UParseDigits(std::string_view digits, Word base,
+                              std::size_t chunk_digits,
+                              std::span<const BigInt> powers) noexcept;
+  // this = digits in base 2^bits, every digit sets its own bits
+  constexpr std::errc UParsePowerOf2Digits(std::string_view digits,
+                                           int bits) noexcept;
+  constexpr std::errc Parse(std::string_view str) noexcept;
 
   constexpr void PowerInner(BigInt& res, BigInt&& exp) const noexcept;
 };
@@ -149,15 +564,29 @@ template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>::BigInt() noexcept
     : words_count{1}
     , is_positive{true} {
+  Grow(1);
   binary[0] = 0;
 }
 
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>::BigInt(const BigInt& other) noexcept
+    : BigInt{other, detail::ResourceAllocator<W>{}} {}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>::BigInt(
+    const BigInt& other, detail::ResourceAllocator<W> allocator) noexcept
     : words_count{other.words_count}
     , is_positive{other.is_positive} {
-  for (std::size_t i = 0; i < words_count; ++i) {
-    binary[i] = other.binary[i];
+  if constexpr (kInfInt) {
+    // Heap words of the same allocator are shared until either of copies
+    // is changed
+    binary = detail::SmallWords<W>{other.binary, allocator};
+  } else {
+    // Word 0 is always there, copied apart so it's known to be written
+    binary[0] = other.binary[0];
+    for (std::size_t i = 1; i < words_count; ++i) {
+      binary[i] = other.binary[i];
+    }
   }
 }
 
@@ -165,8 +594,16 @@ template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>::BigInt(BigInt&& other) noexcept
     : words_count{other.words_count}
     , is_positive{other.is_positive} {
-  for (std::size_t i = 0; i < words_count; ++i) {
-    binary[i] = other.binary[i];
+  if constexpr (kInfInt) {
+    // Buffer is taken, other is left inline zero
+    binary = std::move(other.binary);
+    other.words_count = 1;
+    other.is_positive = true;
+  } else {
+    binary[0] = other.binary[0];
+    for (std::size_t i = 1; i < words_count; ++i) {
+      binary[i] = other.binary[i];
+    }
   }
 }
 
@@ -175,8 +612,13 @@ constexpr BigInt<cap, W, DW>&
 BigInt<cap, W, DW>::operator=(const BigInt& other) noexcept {
   words_count = other.words_count;
   is_positive = other.is_positive;
-  for (std::size_t i = 0; i < words_count; ++i) {
-    binary[i] = other.binary[i];
+  if constexpr (kInfInt) {
+    binary = other.binary;
+  } else {
+    binary[0] = other.binary[0];
+    for (std::size_t i = 1; i < words_count; ++i) {
+      binary[i] = other.binary[i];
+    }
   }
   return *this;
 }
@@ -184,10 +626,28 @@ BigInt<cap, W, DW>::operator=(const BigInt& other) noexcept {
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>&
 BigInt<cap, W, DW>::operator=(BigInt&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  if constexpr (kInfInt) {
+    if (binary.get_allocator() != other.binary.get_allocator()) {
+      return *this = other;
+    }
+  }
+
   words_count = other.words_count;
   is_positive = other.is_positive;
-  for (std::size_t i = 0; i < words_count; ++i) {
-    binary[i] = other.binary[i];
+  if constexpr (kInfInt) {
+    // Buffer is taken, other is left inline zero
+    binary = std::move(other.binary);
+    other.words_count = 1;
+    other.is_positive = true;
+  } else {
+    binary[0] = other.binary[0];
+    for (std::size_t i = 1; i < words_count; ++i) {
+      binary[i] = other.binary[i];
+    }
   }
   return *this;
 }
@@ -197,15 +657,24 @@ constexpr BigInt<cap, W, DW>::BigInt(uint64_t from,
                                      bool from_is_positive) noexcept
     : BigInt{} {
   is_positive = from_is_positive;
+  if constexpr (!kInfInt && cap > 1) {
+    // Fast paths read up to two words, so the second one is written too
+    binary[1] = 0;
+  }
   if (from == 0) {
     return;
   }
 
+  Grow((std::bit_width(from) + kWordBSize - 1) / kWordBSize);
   std::size_t idx = 0;
   while (from != 0) {
     assert(idx < cap && "Given integer won't fit in provided type");
     binary[idx] = kMaxWord & from;
-    from >>= kWordBSize;
+    if constexpr (kWordBSize < 64) {
+      from >>= kWordBSize;
+    } else {
+      from = 0;
+    }
     ++idx;
   }
   words_count = idx;
@@ -214,42 +683,58 @@ constexpr BigInt<cap, W, DW>::BigInt(uint64_t from,
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>::BigInt(std::string_view str) noexcept
     : BigInt{} {
-  ASSERT(str.size() != 0);
+  std::errc ec = Parse(str);
+  ASSERT(ec == std::errc{}, "Malformed number");
+}
 
-  if (str[0] == '-') {
-    is_positive = false;
-    str.remove_prefix(1);
+template<std::size_t cap, typename W, typename DW>
+Expected<BigInt<cap, W, DW>>
+BigInt<cap, W, DW>::FromString(std::string_view str) noexcept {
+  BigInt ret;
+  if (std::errc ec = ret.Parse(str); ec != std::errc{}) {
+    return std::make_error_condition(ec);
   }
+  return ret;
+}
 
-  W base;
-  if (str.size() >= 2 && str.substr(0, 2) == "0b") {
-    base = 2;
-    str.remove_prefix(2);
-  } else {
-    base = 10;
+template<std::size_t cap, typename W, typename DW>
+Expected<BigInt<cap, W, DW>>
+BigInt<cap, W, DW>::FromString(std::string_view str,
+                               std::pmr::memory_resource& resource) noexcept
+  requires(kInfInt)
+{
+  BigInt ret{resource};
+  if (std::errc ec = ret.Parse(str); ec != std::errc{}) {
+    return std::make_error_condition(ec);
   }
+  return ret;
+}
 
-  ASSERT(str.size() != 0);
-  for (char c : str) {
-    if (c == '\'') {
-      continue;
-    }
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>::BigInt(const Range<W> auto& range,
+                                     bool is_positive) noexcept
+    : BigInt{range, detail::ResourceAllocator<W>{}} {
+  this->is_positive = is_positive;
+}
 
-    UMulByShortRange(std::ranges::single_view(base));
-    UAddRange(std::ranges::single_view(static_cast<W>(c - '0')));
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>::BigInt(
+    detail::ResourceAllocator<W> allocator) noexcept
+    : BigInt{} {
+  if constexpr (kInfInt) {
+    binary = detail::SmallWords<W>{allocator};
   }
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>::BigInt(const Range<W> auto& range,
-                                     bool is_positive) noexcept
-    : words_count{1}
-    , is_positive{is_positive} {
-  binary[0] = 0;
+constexpr BigInt<cap, W, DW>::BigInt(
+    const Range<W> auto& range, detail::ResourceAllocator<W> allocator) noexcept
+    : BigInt{allocator} {
   std::size_t counter = 1;
   for (auto it = std::ranges::begin(range); it != std::ranges::end(range);
        ++it) {
     ASSERT(counter <= cap, "Type is too small for provided range");
+    Grow(counter);
     if (*it > 0) {
       words_count = counter;
     }
@@ -262,7 +747,7 @@ constexpr BigInt<cap, W, DW>::BigInt(const Range<W> auto& range,
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>&
 BigInt<cap, W, DW>::operator<<=(std::size_t shift) noexcept {
-  ASSERT(shift < cap * kWordBSize, "Shift is bigger than bit size");
+  ASSERT(kInfInt || shift < cap * kWordBSize, "Shift is bigger than bit size");
 
   if (shift == 0 || IsZero()) {
     return *this;
@@ -270,29 +755,32 @@ BigInt<cap, W, DW>::operator<<=(std::size_t shift) noexcept {
 
   std::size_t word_offset = shift / kWordBSize;
   std::size_t bit_offset = shift % kWordBSize;
+  std::size_t max = std::min(words_count + word_offset + 1, cap);
+  Grow(max);
+  // Words are taken once, non-const access to InfInt ones checks sharing
+  W* const words = binary.data();
+
   auto get_shifted_word = [&](std::size_t idx) -> W {
     W ret = 0;
     if (idx >= word_offset) {
-      ret |= binary[idx - word_offset] << bit_offset;
+      ret |= words[idx - word_offset] << bit_offset;
       if (bit_offset != 0 && idx > word_offset) {
-        ret |= binary[idx - word_offset - 1] >> (kWordBSize - bit_offset);
+        ret |= words[idx - word_offset - 1] >> (kWordBSize - bit_offset);
       }
     }
     return ret;
   };
 
-  std::size_t max = std::min(words_count + word_offset + 1, cap);
-
   if (words_count < cap) {
-    binary[words_count] = 0;
+    words[words_count] = 0;
   }
 
   words_count = 1;
   for (std::size_t i = 0; i < max; ++i) {
     std::size_t idx = max - 1 - i;
-    binary[idx] = get_shifted_word(idx);
+    words[idx] = get_shifted_word(idx);
 
-    if (words_count == 1 && binary[idx] != 0) {
+    if (words_count == 1 && words[idx] != 0) {
       words_count = idx + 1;
     }
   }
@@ -303,7 +791,7 @@ BigInt<cap, W, DW>::operator<<=(std::size_t shift) noexcept {
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>&
 BigInt<cap, W, DW>::operator>>=(std::size_t shift) noexcept {
-  ASSERT(shift < cap * kWordBSize, "Shift is bigger than bit size");
+  ASSERT(kInfInt || shift < cap * kWordBSize, "Shift is bigger than bit size");
 
   if (shift == 0 || IsZero()) {
     return *this;
@@ -313,19 +801,21 @@ BigInt<cap, W, DW>::operator>>=(std::size_t shift) noexcept {
   std::size_t bit_offset = shift % kWordBSize;
 
   if (word_offset >= words_count) {
-    words_count = 1;
-    binary[0] = 0;
+    UResetBinary(std::ranges::single_view(W{0}));
     return *this;
   }
 
+  Grow(words_count);
+  W* const words = binary.data();
+
   auto get_shifted_word = [&](std::size_t idx) -> W {
     W ret = 0;
     if (idx + word_offset < words_count) {
-      ret |= binary[idx + word_offset] >> bit_offset;
+      ret |= words[idx + word_offset] >> bit_offset;
     }
 
     if (bit_offset != 0 && idx + word_offset + 1 < words_count) {
-      ret |= binary[idx + word_offset + 1] << (kWordBSize - bit_offset);
+      ret |= words[idx + word_offset + 1] << (kWordBSize - bit_offset);
     }
 
     return ret;
@@ -333,12 +823,12 @@ BigInt<cap, W, DW>::operator>>=(std::size_t shift) noexcept {
 
   std::size_t max = words_count - word_offset; // max >= 1
   for (std::size_t i = 0; i < max; ++i) {
-    binary[i] = get_shifted_word(i);
+    words[i] = get_shifted_word(i);
   }
 
   if (max == 1) {
     words_count = 1;
-  } else if (binary[max - 1] != 0) {
+  } else if (words[max - 1] != 0) {
     words_count = max;
   } else {
     words_count = max - 1;
@@ -349,13 +839,17 @@ BigInt<cap, W, DW>::operator>>=(std::size_t shift) noexcept {
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>
 BigInt<cap, W, DW>::operator<<(std::size_t shift_int) const noexcept {
-  return BigInt{*this} <<= shift_int;
+  BigInt ret{*this, ScratchAllocator()};
+  ret <<= shift_int;
+  return ret;
 }
 
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>
 BigInt<cap, W, DW>::operator>>(std::size_t shift_int) const noexcept {
-  return BigInt{*this} >>= shift_int;
+  BigInt ret{*this, ScratchAllocator()};
+  ret >>= shift_int;
+  return ret;
 }
 
 template<std::size_t cap, typename W, typename DW>
@@ -366,7 +860,7 @@ BigInt<cap, W, DW>::operator+() const noexcept {
 
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::operator-() const noexcept {
-  BigInt copy = *this;
+  BigInt copy{*this, ScratchAllocator()};
   copy.is_positive ^= true;
   return copy;
 }
@@ -374,506 +868,1869 @@ constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::operator-() const noexcept {
 template<std::size_t cap, typename W, typename DW>
 constexpr void BigInt<cap, W, DW>::UResetBinary(
     const RandomAccessRange<W> auto& range) noexcept {
-  words_count = std::ranges::size(range);
-  if (words_count == 0) {
-    words_count = 1;
-    binary[0] = 0;
-  } else {
-    ASSERT(words_count <= cap);
-    auto range_data = std::ranges::begin(range);
-    for (std::size_t i = 0; i < words_count; ++i) {
-      binary[i] = range_data[i];
-    }
+  if (std::ranges::empty(range)) {
+    UResetBinary(std::ranges::single_view(W{0}));
+    return;
   }
-}
 
-template<std::size_t cap, typename W, typename DW>
-constexpr void
-BigInt<cap, W, DW>::UAddRange(const RandomAccessRange<W> auto& range) noexcept {
+  const std::size_t size = std::ranges::size(range);
+  ASSERT(size <= cap);
   auto range_data = std::ranges::begin(range);
-  std::size_t range_wc = std::ranges::size(range);
-  std::size_t i = 0;
-  for (bool carry = false; carry || i < range_wc; ++i) {
-    ASSERT(i < cap, "Addition overflow");
-
-    W lhs{0}, rhs{0};
-    if (i < words_count) {
-      lhs = binary[i];
-    }
-    if (i < range_wc) {
-      rhs = range_data[i];
+  if constexpr (kInfInt) {
+    // Range may point to the replaced words, so they are copied first
+    if (size > binary.size() || binary.IsShared()) {
+      detail::SmallWords<W> fresh(std::max(size, binary.size()),
+                                  binary.get_allocator());
+      std::copy_n(range_data, size, fresh.begin());
+      binary = std::move(fresh);
+      words_count = size;
+      return;
     }
+  }
+  words_count = size;
+  std::copy_n(range_data, size, binary.begin());
+}
 
-    if (rhs != kMaxWord || !carry) {
-      if (carry) {
-        rhs += 1;
-      }
-
-      if (kMaxWord - lhs < rhs) {
-        carry = true;
-      } else {
-        carry = false;
-      }
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UAddRange(std::span<const W> range,
+                                             std::size_t offset) noexcept {
+  if (offset != 0 && RangeIsZero(range)) {
+    return;
+  }
 
-      binary[i] = lhs + rhs;
-    } else if (i >= words_count) {
-      binary[i] = 0;
-    }
+  const std::size_t range_end = range.size() + offset;
+  ASSERT(range_end <= cap, "Addition overflow");
+  // Room for carry
+  const auto old_binary = Grow(std::max(words_count, range_end) + 1, range);
+  W* const words = binary.data();
+  for (std::size_t i = words_count; i < range_end; ++i) {
+    words[i] = 0;
   }
 
-  if (i > words_count) {
-    words_count = i;
+  std::size_t size = std::max(words_count, range_end);
+  if (Kernel::Add({words + offset, size - offset}, range)) {
+    ASSERT(size < cap, "Addition overflow");
+    words[size++] = 1;
   }
+  words_count = size;
 }
 
 template<std::size_t cap, typename W, typename DW>
 constexpr bool
-BigInt<cap, W, DW>::USubRange(const RandomAccessRange<W> auto& range) noexcept {
-  auto lhs_data = std::ranges::begin(ToView());
-  std::size_t lhs_wc = words_count;
-
-  auto rhs_data = std::ranges::begin(range);
-  std::size_t rhs_wc = std::ranges::size(range);
-
-  bool this_ge = UCompare(range) >= 0;
-  if (!this_ge) {
-    std::swap(lhs_data, rhs_data);
-    std::swap(lhs_wc, rhs_wc);
-  }
-
-  words_count = 1;
-  std::size_t i = 0;
-  for (bool borrow = false; borrow || i < rhs_wc; ++i) {
-    W lhs{0}, rhs{0};
-    if (i < lhs_wc) {
-      lhs = lhs_data[i];
-    }
-    if (i < rhs_wc) {
-      rhs = rhs_data[i];
-    }
-
-    binary[i] = lhs;
-    if (rhs != kMaxWord || !borrow) {
-      if (borrow) {
-        rhs += 1;
-      }
-
-      if (lhs < rhs) {
-        borrow = true;
-      } else {
-        borrow = false;
-      }
-
-      binary[i] -= rhs;
+BigInt<cap, W, DW>::USubRange(std::span<const W> range) noexcept {
+  const bool this_ge = UCompare(range) >= 0;
+  const auto old_binary = Grow(range.size(), range);
+  std::span<W> words{binary.data(), std::max(words_count, range.size())};
+  if (this_ge) {
+    Kernel::Sub(words, range);
+  } else {
+    // this = range - this, high words of range are taken with borrow
+    const std::size_t n = words_count;
+    bool borrow = Kernel::SubN(words.first(n), range.first(n), words.first(n));
+    std::ranges::copy(range.subspan(n), words.begin() + n);
+    if (borrow) {
+      Kernel::SubWord(words.subspan(n), 1);
     }
+  }
 
-    if (binary[i] != 0) {
-      words_count = i + 1;
-    }
+  words_count = words.size();
+  while (words_count > 1 && binary[words_count - 1] == 0) {
+    --words_count;
   }
+  return !this_ge;
+}
 
-  if (i < lhs_wc) {
-    words_count = lhs_wc;
+template<std::size_t cap, typename W, typename DW>
+constexpr DW BigInt<cap, W, DW>::UDoubleWord() const noexcept {
+  DW ret = binary[0];
+  if (words_count > 1) {
+    ret |= static_cast<DW>(binary[1]) << kWordBSize;
   }
+  return ret;
+}
 
-  for (; i < words_count; ++i) {
-    binary[i] = lhs_data[i];
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UResetDoubleWord(DW value,
+                                                    bool carry) noexcept {
+  const W high = static_cast<W>(value >> kWordBSize);
+  words_count = carry ? 3 : (high != 0 ? 2 : 1);
+  ASSERT(words_count <= cap, "Number doesn't fit");
+  Grow(words_count);
+  binary[0] = static_cast<W>(value);
+  if (words_count > 1) {
+    binary[1] = high;
+  }
+  if (carry) {
+    binary[2] = 1;
   }
+}
 
-  return !this_ge;
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::ShortAdd(DW rhs,
+                                            bool rhs_is_positive) noexcept {
+  const DW lhs = UDoubleWord();
+  if (is_positive == rhs_is_positive) {
+    const DW sum = static_cast<DW>(lhs + rhs);
+    UResetDoubleWord(sum, sum < lhs);
+  } else if (lhs >= rhs) {
+    UResetDoubleWord(static_cast<DW>(lhs - rhs));
+  } else {
+    UResetDoubleWord(static_cast<DW>(rhs - lhs));
+    is_positive = rhs_is_positive;
+  }
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator+=(const BigInt& rhs) noexcept {
-  if (is_positive ^ rhs.is_positive) {
+template<std::size_t rhs_cap>
+constexpr void BigInt<cap, W, DW>::AddSigned(const BigInt<rhs_cap, W, DW>& rhs,
+                                             bool positive) noexcept {
+  const bool rhs_is_positive = rhs.is_positive == positive;
+  if (words_count <= 2 && rhs.words_count <= 2) {
+    ShortAdd(rhs.UDoubleWord(), rhs_is_positive);
+  } else if (is_positive ^ rhs_is_positive) {
     is_positive ^= USubRange(rhs.ToView());
   } else {
     UAddRange(rhs.ToView());
   }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator+=(const BigInt& rhs) noexcept {
+  AddSigned(rhs, true);
   return *this;
 }
 
 template<std::size_t cap, typename W, typename DW>
 constexpr BigInt<cap, W, DW>&
 BigInt<cap, W, DW>::operator-=(const BigInt& rhs) noexcept {
-  if (is_positive ^ rhs.is_positive) {
-    UAddRange(rhs.ToView());
-  } else {
-    is_positive ^= USubRange(rhs.ToView());
-  }
+  AddSigned(rhs, false);
   return *this;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr void BigInt<cap, W, DW>::UMulByShortRange(
-    const RandomAccessRange<W> auto& range) noexcept {
+template<std::size_t rhs_cap>
+  requires(rhs_cap != cap)
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator+=(const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  AddSigned(rhs, true);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t rhs_cap>
+  requires(rhs_cap != cap)
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator-=(const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  AddSigned(rhs, false);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void
+BigInt<cap, W, DW>::UMulByShortRange(std::span<const W> range) noexcept {
   if (IsZero()) {
     return;
   } else if (RangeIsZero(range)) {
-    words_count = 1;
-    binary[0] = 0;
+    UResetBinary(range);
     return;
   }
 
-  std::size_t range_wc = std::ranges::size(range);
-
-  ASSERT(words_count == 1 || range_wc == 1,
+  ASSERT(words_count == 1 || range.size() == 1,
          "Short multiplication not applicable");
 
-  auto range_data = std::ranges::begin(range);
-  std::size_t i = 0;
-  W lhs{binary[0]}, rhs{range_data[0]};
-  binary[0] = 0;
-  for (; i < words_count || i < range_wc; ++i) {
-    DW prod = static_cast<DW>(lhs) * rhs;
-    if (i + 1 < words_count) {
-      lhs = binary[i + 1];
-    } else if (i + 1 < range_wc) {
-      rhs = range_data[i + 1];
-    }
-
-    W prod_l = prod;
-    W prod_h = prod >> kWordBSize;
-
-    if (i + 1 < cap) {
-      binary[i + 1] = prod_h;
-    } else {
-      ASSERT(prod_h == 0, "Multiplication overflow");
-    }
-
-    if (kMaxWord - prod_l < binary[i]) {
-      ASSERT(i + 1 < cap, "Multiplication overflow");
-      binary[i + 1] += 1;
-    }
-
-    binary[i] += prod_l;
+  W word = range[0];
+  if (range.size() > 1) {
+    word = binary[0];
+    UResetBinary(range);
   }
 
-  if (i < cap && binary[i] != 0) {
-    words_count = i + 1;
-  } else {
-    words_count = i;
+  Grow(words_count);
+  std::span<W> words{binary.data(), words_count};
+  if (W high = Kernel::Mul1(words, words, word); high != 0) {
+    ASSERT(words_count < cap, "Multiplication overflow");
+    Grow(words_count + 1);
+    binary[words_count++] = high;
   }
 }
 
 template<std::size_t cap, typename W, typename DW>
-template<std::size_t subint_cap>
 constexpr void BigInt<cap, W, DW>::KaratsubaUMulByRange(
     const RandomAccessRange<W> auto& range) noexcept {
-  // Multiplication result fits into SmallInt
-  using SmallInt = BigInt<subint_cap, W, DW>;
-
-  const std::size_t mid_thr =
-      (std::max(std::ranges::size(range), words_count) + 1) / 2;
-
-  SmallInt this_l{std::ranges::take_view(ToView(), mid_thr)};
-  SmallInt this_h{std::ranges::drop_view(ToView(), mid_thr)};
-
-  SmallInt rhs_l{std::ranges::take_view(range, mid_thr)};
-  SmallInt rhs_h{std::ranges::drop_view(range, mid_thr)};
-
-  // 2^32 * (
-  //      2^32 * (this_h * rhs_h)
-  //        + (this_h + this_l) * (rhs_h + rhs_l)
-  //        - this_h * rhs_h
-  //        - this_l * rhs_l
-  //  ) + this_l * rhs_l
-  SmallInt mix = (this_l + this_h) * (rhs_l + rhs_h);
-  SmallInt ups = this_h * rhs_h;
-  SmallInt lws = this_l * rhs_l;
-
-  UResetBinary(ups.ToView());
-  *this <<= mid_thr * kWordBSize;
-  UAddRange(mix.ToView());
-  USubRange(ups.ToView());
-  USubRange(lws.ToView());
-  *this <<= mid_thr * kWordBSize;
-  UAddRange(lws.ToView());
+  const Scratch rhs(std::ranges::begin(range), std::ranges::end(range),
+                    ScratchAllocator());
+  const std::size_t max_wc = std::max(rhs.size(), words_count);
+
+  // Product is followed by scratch of all recursion levels
+  Scratch buffer(words_count + rhs.size() +
+                     Kernel::KaratsubaScratchSize(max_wc),
+                 ScratchAllocator());
+  std::span<W> ret{buffer.data(), words_count + rhs.size()};
+  Kernel::KaratsubaMul(ret, {binary.data(), words_count}, rhs,
+                       std::span<W>{buffer}.subspan(ret.size()));
+
+  while (ret.size() > 1 && ret.back() == 0) {
+    ret = ret.first(ret.size() - 1);
+  }
+  ASSERT(ret.size() <= cap, "Multiplication overflow");
+  UResetBinary(ret);
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr void BigInt<cap, W, DW>::UMulByRange(
-    const RandomAccessRange<W> auto& range) noexcept {
-  std::size_t range_wc = std::ranges::size(range);
-  if (words_count == 1 || range_wc == 1) {
-    UMulByShortRange(range);
-  } else if constexpr (cap < 40) {
-    BigInt ret;
-    auto it = std::ranges::begin(range);
-    for (std::size_t i = 0; i < range_wc; ++i, ++it) {
-      if (*it == 0) {
-        continue;
-      }
-      BigInt tmp{std::ranges::single_view(*it)};
-      tmp.UMulByShortRange(ToView());
-      tmp <<= i * kWordBSize;
-      ret.UAddRange(tmp.ToView());
+template<std::size_t parts, std::size_t points>
+constexpr std::array<BigInt<cap, W, DW>, points>
+BigInt<cap, W, DW>::ToomEvaluate(
+    const RandomAccessRange<W> auto& range, std::size_t part,
+    detail::ResourceAllocator<W> allocator) noexcept {
+  static_assert(points == 4 || points == 5 || points == 7,
+                "Unsupported Toom-Cook split");
+
+  auto a = Zeros<parts>(allocator);
+  BigInt even{allocator}, odd{allocator}, even2{allocator}, odd2{allocator},
+      half{allocator};
+  for (std::size_t i = 0; i < parts; ++i) {
+    a[i] = BigInt{
+        std::ranges::take_view(std::ranges::drop_view(range, i * part), part),
+        allocator};
+    (i % 2 == 0 ? even : odd) += a[i];
+    if constexpr (points >= 5) {
+      (i % 2 == 0 ? even2 : odd2) += a[i] << i;
+    }
+    if constexpr (points >= 7) {
+      half += a[i] << (parts - 1 - i);
     }
-    UResetBinary(ret.ToView());
-  } else {
-    std::size_t max_size = words_count + range_wc;
-#define TRY_OPTIMIZE(small_cap)                                                \
-  if (max_size <= small_cap) {                                                 \
-    KaratsubaUMulByRange<small_cap>(range);                                    \
-    return;                                                                    \
   }
 
-    TRY_OPTIMIZE(cap / 16 + 1);
-    TRY_OPTIMIZE(cap / 8 + 1);
-    TRY_OPTIMIZE(cap / 4 + 1);
-    TRY_OPTIMIZE(cap / 2 + 1);
-#undef TRY_OPTIMIZE
-    KaratsubaUMulByRange<cap>(range);
+  // Value in 1/2 is multiplied by 2^(parts - 1) to stay integer
+  auto ret = Zeros<points>(allocator);
+  ret[0] = a[0];
+  ret[1] = even + odd;
+  ret[2] = even - odd;
+  if constexpr (points >= 5) {
+    ret[3] = even2 + odd2;
   }
+  if constexpr (points >= 7) {
+    ret[4] = even2 - odd2;
+    ret[5] = half;
+  }
+  ret[points - 1] = a[parts - 1];
+  return ret;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator*=(const BigInt& rhs) noexcept {
-  is_positive ^= !rhs.is_positive;
+template<std::size_t points>
+constexpr void
+BigInt<cap, W, DW>::ToomInterpolate(const std::array<BigInt, points>& r,
+                                    std::size_t part) noexcept {
 
-  if (rhs.IsPowerOf2()) {
-    *this <<= rhs.BitWidth() - 1;
+  auto div = [](BigInt value, W divisor) {
+    value.UDivByWord(divisor);
+    return value;
+  };
+
+  // Restore coefficients of c0 + c1 x + ... from its values r[i]
+  auto c = Zeros<points>(ScratchAllocator());
+  c[0] = r[0];
+  c[points - 1] = r[points - 1];
+  if constexpr (points == 4) {
+    c[2] = ((r[1] + r[2]) >> 1) - c[0];
+    c[1] = ((r[1] - r[2]) >> 1) - c[3];
+  } else if constexpr (points == 5) {
+    c[2] = ((r[1] + r[2]) >> 1) - c[0] - c[4];
+    BigInt odd = (r[1] - r[2]) >> 1; // c1 + c3
+    c[3] = div(((r[3] - c[0] - (c[2] << 2) - (c[4] << 4)) >> 1) - odd, 3);
+    c[1] = odd - c[3];
   } else {
-    UMulByRange(rhs.ToView());
+    BigInt e1 = ((r[1] + r[2]) >> 1) - c[0] - c[6]; // c2 + c4
+    BigInt o1 = (r[1] - r[2]) >> 1;                 // c1 + c3 + c5
+    BigInt e2 = (((r[3] + r[4]) >> 1) - c[0] - (c[6] << 6)) >> 2; // c2 + 4 c4
+    BigInt o2 = (r[3] - r[4]) >> 2; // c1 + 4 c3 + 16 c5
+    c[4] = div(e2 - e1, 3);
+    c[2] = e1 - c[4];
+    // 16 c1 + 4 c3 + c5
+    BigInt h =
+        (r[5] - (c[0] << 6) - (c[2] << 4) - (c[4] << 2) - c[6]) >> 1;
+    BigInt x = div(o2 - o1, 3); // c3 + 5 c5
+    BigInt y = div(h - o1, 3);  // 5 c1 + c3
+    c[3] = div((o1 << 2) + o1 - x - y, 3);
+    c[5] = div(x - c[3], 5);
+    c[1] = div(y - c[3], 5);
   }
 
-  return *this;
+  UResetBinary(std::ranges::single_view(W{0}));
+  for (std::size_t i = 0; i < points; ++i) {
+    UAddRange(c[i].ToView(), i * part);
+  }
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr W BigInt<cap, W, DW>::UDivByWord(W rhs) noexcept {
-  BigInt remainder;
-  DW window = 0;
-  for (std::size_t i = 0; i < words_count; ++i) {
-    window = (window << kWordBSize) + binary[words_count - 1 - i];
-    if (window >= rhs) {
-      binary[words_count - 1 - i] = window / rhs;
-      window %= rhs;
-    } else {
-      binary[words_count - 1 - i] = 0;
+template<std::size_t this_parts, std::size_t range_parts>
+constexpr void BigInt<cap, W, DW>::ToomUMulByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  constexpr std::size_t points = this_parts + range_parts - 1;
+
+  const std::size_t part =
+      std::max((words_count + this_parts - 1) / this_parts,
+               (std::ranges::size(range) + range_parts - 1) / range_parts);
+
+  auto r = ToomEvaluate<this_parts, points>(ToView(), part, ScratchAllocator());
+  {
+    auto rhs =
+        ToomEvaluate<range_parts, points>(range, part, ScratchAllocator());
+    for (std::size_t i = 0; i < points; ++i) {
+      r[i] *= rhs[i];
     }
   }
-
-  if (words_count > 1 && binary[words_count - 1] == 0) {
-    words_count -= 1;
-  }
-
-  return static_cast<W>(window);
+  ToomInterpolate<points>(r, part);
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::UDivBySameRange(
+constexpr void BigInt<cap, W, DW>::UnbalancedUMulByRange(
     const RandomAccessRange<W> auto& range) noexcept {
-  if (IsZero()) {
-    UResetBinary(std::ranges::single_view(W{0}));
-    return 0;
-  }
-
-  ASSERT(BitWidth() - RangeBitWidth(range) <= kWordBSize,
-         "Same division not applicable");
 
-  // Use binary search for division
-  W l{0}; // unreachable edge
-  W r{kMaxWord};
-  while (l < r) {
-    // ceil((l + r) / 2) without overflow
-    W m = (l >> 1) + (r >> 1) + ((l | r) & 1);
-
-    BigInt q{ToView()};
-    q.UDivByWord(m);
-    if (auto cmp = q.UCompare(range); cmp < 0) {
-      r = m - 1;
-    } else {
-      l = m;
+  auto mul = [this](const auto& lng, const auto& shrt) {
+    const std::size_t block = std::ranges::size(shrt);
+    const BigInt shrt_int{shrt, ScratchAllocator()};
+
+    BigInt ret{ScratchAllocator()};
+    for (std::size_t offset = 0; offset < std::ranges::size(lng);
+         offset += block) {
+      BigInt prod{
+          std::ranges::take_view(std::ranges::drop_view(lng, offset), block),
+          ScratchAllocator()};
+      prod *= shrt_int;
+      ret.UAddRange(prod.ToView(), offset);
     }
+    UResetBinary(ret.ToView());
+  };
+
+  if (words_count > std::ranges::size(range)) {
+    mul(ToView(), range);
+  } else {
+    mul(range, ToView());
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::BalancedUMulByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  const std::size_t max_wc = std::max(std::ranges::size(range), words_count);
+  if constexpr (cap > kToom4Threshold) {
+    if (max_wc >= kToom4Threshold) {
+      ToomUMulByRange<4, 4>(range);
+      return;
+    }
+  }
+  if constexpr (cap > kToom3Threshold) {
+    if (max_wc >= kToom3Threshold) {
+      ToomUMulByRange<3, 3>(range);
+      return;
+    }
+  }
+  KaratsubaUMulByRange(range);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::SplitUMulByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  const std::size_t range_wc = std::ranges::size(range);
+  const std::size_t max_wc = std::max(range_wc, words_count);
+  const std::size_t min_wc = std::min(range_wc, words_count);
+
+  if (max_wc >= 3 * min_wc) {
+    UnbalancedUMulByRange(range);
+    return;
+  }
+
+  if constexpr (cap > kToom3Threshold) {
+    // Toom-3/2 fits 3:2 ratio best, Toom-4/2 fits 2:1
+    if (max_wc >= kToom3Threshold && 4 * max_wc >= 5 * min_wc) {
+      const bool this_longer = words_count > range_wc;
+      if (4 * max_wc >= 7 * min_wc) {
+        this_longer ? ToomUMulByRange<4, 2>(range)
+                    : ToomUMulByRange<2, 4>(range);
+      } else {
+        this_longer ? ToomUMulByRange<3, 2>(range)
+                    : ToomUMulByRange<2, 3>(range);
+      }
+      return;
+    }
+  }
+
+  BalancedUMulByRange(range);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::NttUMulByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  Scratch ret = detail::NttMultiply<W>(ToView(), range, ScratchAllocator());
+  while (ret.size() > 1 && ret.back() == 0) {
+    ret.pop_back();
+  }
+  ASSERT(ret.size() <= cap, "Multiplication overflow");
+  UResetBinary(ret);
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t max_cap, std::size_t small_cap>
+constexpr decltype(auto)
+BigInt<cap, W, DW>::WithCapacity(std::size_t size, auto&& f) noexcept {
+  if constexpr (kInfInt || small_cap >= max_cap) {
+    return f.template operator()<max_cap>();
+  } else {
+    if (size <= small_cap) {
+      return f.template operator()<small_cap>();
+    }
+    return WithCapacity<max_cap, 2 * small_cap>(size, f);
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UMulByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  std::size_t range_wc = std::ranges::size(range);
+  if (words_count == 1 || range_wc == 1) {
+    UMulByShortRange(range);
+  } else if constexpr (cap < 40) {
+    std::span<const W> lhs{binary.data(), words_count};
+    std::span<const W> rhs{std::ranges::data(range), range_wc};
+    if (lhs.size() < rhs.size()) {
+      std::swap(lhs, rhs);
+    }
+
+    // Product is written aside, range may point to this->binary
+    std::array<W, 2 * cap> buffer;
+    std::span<W> ret{buffer.data(), lhs.size() + rhs.size()};
+    Kernel::BasecaseMul(ret, lhs, rhs);
+    if (ret.back() == 0) {
+      ret = ret.first(ret.size() - 1);
+    }
+    ASSERT(ret.size() <= cap, "Multiplication overflow");
+    UResetBinary(ret);
+  } else {
+    std::size_t max_size = words_count + range_wc;
+    if (std::min(words_count, range_wc) >= kNttThreshold &&
+        detail::NttFits(max_size * kWordBSize)) {
+      NttUMulByRange(range);
+      return;
+    }
+
+    WithCapacity<cap>(max_size, [&]<std::size_t small_cap>() {
+      if constexpr (small_cap == cap) {
+        SplitUMulByRange(range);
+      } else {
+        BigInt<small_cap, W, DW> prod{ToView()};
+        prod.SplitUMulByRange(range);
+        UResetBinary(prod.ToView());
+      }
+    });
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t ret_cap>
+constexpr void BigInt<cap, W, DW>::UMulInto(BigInt<ret_cap, W, DW>& ret,
+                                            std::span<const W> lhs,
+                                            std::span<const W> rhs) noexcept {
+  if (lhs.data() == rhs.data() && lhs.size() == rhs.size()) {
+    ret.UResetBinary(lhs);
+    ret.Square();
+    return;
+  } else if (lhs.size() < rhs.size()) {
+    std::swap(lhs, rhs);
+  }
+
+  if (rhs.size() >= Kernel::kKaratsubaThreshold) {
+    ret.UResetBinary(lhs);
+    ret.UMulByRange(rhs);
+    return;
+  }
+
+  // Product is written right into words of ret
+  const std::size_t size = lhs.size() + rhs.size();
+  ASSERT(size <= ret_cap, "Multiplication overflow");
+  ret.Grow(size);
+  Kernel::BasecaseMul({ret.binary.data(), size}, lhs, rhs);
+  ret.words_count = size;
+  while (ret.words_count > 1 && ret.binary[ret.words_count - 1] == 0) {
+    --ret.words_count;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::AddProduct(const BigInt& x,
+                                              const BigInt& y,
+                                              bool positive) noexcept {
+  if (x.IsZero() || y.IsZero()) {
+    return;
+  }
+
+  std::span<const W> lhs{x.binary.data(), x.words_count};
+  std::span<const W> rhs{y.binary.data(), y.words_count};
+  if (lhs.size() < rhs.size()) {
+    std::swap(lhs, rhs);
+  }
+
+  // Karatsuba multiplication is faster for long operands, rows can't be
+  // added to operand and product may overflow though the result doesn't
+  if (rhs.size() < Kernel::kKaratsubaThreshold && &x != this && &y != this &&
+      lhs.size() + rhs.size() <= cap) {
+    AddMulRows(lhs, rhs, (x.is_positive == y.is_positive) == positive);
+  } else if (positive) {
+    *this += x * y;
+  } else {
+    *this -= x * y;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::AddWordProduct(const BigInt& x, W word,
+                                                  bool positive) noexcept {
+  if (x.IsZero() || word == 0) {
+    return;
+  }
+
+  const std::span<const W> rhs{&word, 1};
+  if (&x != this && x.words_count < cap) {
+    AddMulRows({x.binary.data(), x.words_count}, rhs,
+               x.is_positive == positive);
+    return;
+  }
+
+  BigInt product{x, ScratchAllocator()};
+  product.UMulByShortRange(rhs);
+  if (positive) {
+    *this += product;
+  } else {
+    *this -= product;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void
+BigInt<cap, W, DW>::AddMulRows(std::span<const W> lhs, std::span<const W> rhs,
+                               bool product_is_positive) noexcept {
+  if (IsZero()) {
+    is_positive = product_is_positive;
+  }
+  const bool subtract = is_positive != product_is_positive;
+
+  std::size_t size = std::max(words_count, lhs.size() + rhs.size());
+  Grow(size);
+  std::span<W> words{binary.data(), size};
+  std::ranges::fill(words.subspan(words_count), W{0});
+
+  // Partial sums change monotonically, so carry (borrow) out of words
+  // happens at most once
+  bool carry = false;
+  for (std::size_t i = 0; i < rhs.size(); ++i) {
+    std::span<W> row = words.subspan(i, lhs.size());
+    if (subtract) {
+      const W high = Kernel::SubMul1(row, lhs, rhs[i]);
+      carry |= Kernel::SubWord(words.subspan(i + lhs.size()), high);
+    } else {
+      const W high = Kernel::AddMul1(row, lhs, rhs[i]);
+      carry |= Kernel::AddWord(words.subspan(i + lhs.size()), high);
+    }
+  }
+
+  if (carry && !subtract) {
+    ASSERT(size < cap, "Addition overflow");
+    Grow(size + 1);
+    binary[size++] = 1;
+  } else if (carry) {
+    // Product is greater than this, difference is negated from its two's
+    // complement
+    Kernel::Not(words);
+    Kernel::AddWord(words, 1);
+    is_positive = !is_positive;
+  }
+
+  words_count = size;
+  while (words_count > 1 && binary[words_count - 1] == 0) {
+    --words_count;
+  }
+  if (IsZero()) {
+    is_positive = true;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::BasecaseUSquare() noexcept {
+  std::array<W, 2 * cap> buffer;
+  std::span<W> ret{buffer.data(), 2 * words_count};
+  Kernel::BasecaseSquare(ret, {binary.data(), words_count});
+  if (ret.back() == 0) {
+    ret = ret.first(ret.size() - 1);
+  }
+  ASSERT(ret.size() <= cap, "Multiplication overflow");
+  UResetBinary(ret);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::KaratsubaUSquare() noexcept {
+  Scratch buffer(2 * words_count + Kernel::KaratsubaScratchSize(words_count),
+                 ScratchAllocator());
+  std::span<W> ret{buffer.data(), 2 * words_count};
+  Kernel::KaratsubaSquare(ret, {binary.data(), words_count},
+                          std::span<W>{buffer}.subspan(ret.size()));
+
+  while (ret.size() > 1 && ret.back() == 0) {
+    ret = ret.first(ret.size() - 1);
+  }
+  ASSERT(ret.size() <= cap, "Multiplication overflow");
+  UResetBinary(ret);
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t parts>
+constexpr void BigInt<cap, W, DW>::ToomUSquare() noexcept {
+  constexpr std::size_t points = 2 * parts - 1;
+
+  const std::size_t part = (words_count + parts - 1) / parts;
+  auto r = ToomEvaluate<parts, points>(ToView(), part, ScratchAllocator());
+  for (auto& value : r) {
+    value.Square();
+  }
+  ToomInterpolate<points>(r, part);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::BalancedUSquare() noexcept {
+  if constexpr (cap > kToom4Threshold) {
+    if (words_count >= kToom4Threshold) {
+      ToomUSquare<4>();
+      return;
+    }
+  }
+  if constexpr (cap > kToom3Threshold) {
+    if (words_count >= kToom3Threshold) {
+      ToomUSquare<3>();
+      return;
+    }
+  }
+  KaratsubaUSquare();
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::NttUSquare() noexcept {
+  Scratch ret = detail::NttSquare<W>(ToView(), ScratchAllocator());
+  while (ret.size() > 1 && ret.back() == 0) {
+    ret.pop_back();
+  }
+  ASSERT(ret.size() <= cap, "Multiplication overflow");
+  UResetBinary(ret);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::USquare() noexcept {
+  if (words_count == 1) {
+    UMulByShortRange(ToView());
+  } else if constexpr (cap < 40) {
+    BasecaseUSquare();
+  } else {
+    std::size_t max_size = 2 * words_count;
+    if (words_count >= kNttThreshold &&
+        detail::NttFits(max_size * kWordBSize)) {
+      NttUSquare();
+      return;
+    }
+
+    WithCapacity<cap>(max_size, [this]<std::size_t small_cap>() {
+      if constexpr (small_cap == cap) {
+        BalancedUSquare();
+      } else {
+        BigInt<small_cap, W, DW> square{ToView()};
+        square.BalancedUSquare();
+        UResetBinary(square.ToView());
+      }
+    });
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>& BigInt<cap, W, DW>::Square() noexcept {
+  is_positive = true;
+  if (IsPowerOf2()) {
+    *this <<= BitWidth() - 1;
+  } else {
+    USquare();
+  }
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<typename Lazy>
+  requires requires(const Lazy& expr, BigInt<cap, W, DW>& acc) {
+    expr.AddTo(acc);
+  }
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator=(const Lazy& expr) noexcept {
+  // Terms are added one by one, so this can't be their operand
+  if (expr.Aliases(*this)) {
+    BigInt value{ScratchAllocator()};
+    expr.AddTo(value);
+    return *this = std::move(value);
+  }
+  UResetBinary(std::ranges::single_view(W{0}));
+  is_positive = true;
+  expr.AddTo(*this);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<typename Lazy>
+  requires requires(const Lazy& expr, BigInt<cap, W, DW>& acc) {
+    expr.AddTo(acc);
+  }
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator+=(const Lazy& expr) noexcept {
+  if (expr.Aliases(*this)) {
+    BigInt value{ScratchAllocator()};
+    expr.AddTo(value);
+    return *this += value;
+  }
+  expr.AddTo(*this);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<typename Lazy>
+  requires requires(const Lazy& expr, BigInt<cap, W, DW>& acc) {
+    expr.AddTo(acc);
+  }
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator-=(const Lazy& expr) noexcept {
+  if (expr.Aliases(*this)) {
+    BigInt value{ScratchAllocator()};
+    expr.AddTo(value);
+    return *this -= value;
+  }
+  expr.AddTo(*this, false);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator*=(const BigInt& rhs) noexcept {
+  if (words_count == 1 && rhs.words_count == 1) {
+    is_positive ^= !rhs.is_positive;
+    UResetDoubleWord(static_cast<DW>(binary[0]) * rhs.binary[0]);
+    return *this;
+  } else if (&rhs == this) {
+    return Square();
+  }
+
+  is_positive ^= !rhs.is_positive;
+
+  if (rhs.IsPowerOf2()) {
+    *this <<= rhs.BitWidth() - 1;
+  } else {
+    UMulByRange(rhs.ToView());
+  }
+
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr W BigInt<cap, W, DW>::UDivByWord(W rhs) noexcept {
+  // Quotient of (this << shift) / (rhs << shift) is the same
+  const int shift = std::countl_zero(rhs);
+  const W d = static_cast<W>(rhs << shift);
+  return UDivByWord(d, Kernel::Reciprocal(d), shift);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr W BigInt<cap, W, DW>::UModByWord(W rhs) const noexcept {
+  const int shift = std::countl_zero(rhs);
+  const W d = static_cast<W>(rhs << shift);
+  return UModByWord(d, Kernel::Reciprocal(d), shift);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr W BigInt<cap, W, DW>::UDivByWord(W d, W v, int shift) noexcept {
+  Grow(words_count);
+  const W remainder =
+      Kernel::DivByWord({binary.data(), words_count}, d, v, shift);
+  if (words_count > 1 && binary[words_count - 1] == 0) {
+    words_count -= 1;
+  }
+  return remainder;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr W BigInt<cap, W, DW>::UModByWord(W d, W v, int shift) const noexcept {
+  return Kernel::ModByWord(ToView(), d, v, shift);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::BurnikelDivide(
+    std::span<W> u, std::span<const W> v, W v_inv, std::span<W> q,
+    detail::ResourceAllocator<W> allocator) noexcept {
+  const std::size_t n = v.size();
+  const std::size_t k = q.size();
+
+  if (k > n) {
+    // Quotient is computed by blocks of n words starting from the top one
+    for (std::size_t end = k; end > 0;) {
+      std::size_t begin = end > n ? end - n : 0;
+      Divide(u.subspan(begin, end - begin + n), v, v_inv,
+             q.subspan(begin, end - begin), allocator);
+      end = begin;
+    }
+  } else if (k == n) {
+    const std::size_t lo = k / 2;
+    Divide(u.subspan(lo), v, v_inv, q.subspan(lo), allocator);
+    Divide(u.first(lo + n), v, v_inv, q.first(lo), allocator);
+  } else {
+    // Estimate quotient by division of top 2k words of u by top k words of
+    // v, estimation is at most 2 greater than actual quotient
+    std::span<W> u_top = u.subspan(n - k);
+    std::span<const W> v_top = v.subspan(n - k);
+    if (std::ranges::equal(u_top.subspan(k), v_top)) {
+      // Quotient would be B^k here, use B^k - 1 instead
+      std::ranges::fill(q, kMaxWord);
+      std::ranges::fill(u_top.subspan(k), W{0});
+      u_top[k] = Kernel::Add(u_top.first(k), v_top);
+    } else {
+      Divide(u_top, v_top, v_inv, q, allocator);
+    }
+
+    BigInt prod{q, allocator};
+    prod.UMulByRange(BigInt{v.first(n - k), allocator}.ToView());
+    for (bool borrow = Kernel::Sub(u, prod.ToView()); borrow;) {
+      Kernel::SubWord(q, 1);
+      borrow = !Kernel::Add(u, v);
+    }
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr typename BigInt<cap, W, DW>::Scratch
+BigInt<cap, W, DW>::NewtonReciprocal(
+    std::span<const W> v, detail::ResourceAllocator<W> allocator) noexcept {
+  const std::size_t n = v.size();
+  ASSERT(2 * n <= cap);
+
+  bool by_division = true;
+  if constexpr (cap >= 2 * kNewtonThreshold) {
+    by_division = n < kNewtonThreshold;
+  }
+
+  if (by_division) {
+    // B^2n - 1 - B^n v has the same quotient with its top words lesser
+    // than v
+    Scratch u(2 * n, kMaxWord, allocator);
+    for (std::size_t i = 0; i < n; ++i) {
+      u[n + i] = static_cast<W>(~v[i]);
+    }
+    Scratch ret(n, allocator);
+    Divide(u, v, ret, allocator);
+    return ret;
+  }
+
+  if constexpr (cap >= 2 * kNewtonThreshold) {
+    const std::size_t lo = n / 2;
+    const std::size_t hi = n - lo;
+
+    // x = (B^hi + inv_hi) B^lo approximates B^2n / v with hi correct words,
+    // one step of Newton iteration x += x (B^2n - v x) / B^2n doubles them
+    const Scratch inv_hi_words =
+        WithCapacity<cap>(2 * hi, [&]<std::size_t small_cap>() {
+          return BigInt<small_cap, W, DW>::NewtonReciprocal(v.subspan(lo),
+                                                            allocator);
+        });
+    BigInt inv_hi{inv_hi_words, allocator};
+    BigInt divisor{v, allocator};
+
+    // error = B^2n - v x = (B^n - v) B^n - v inv_hi B^lo
+    BigInt error{std::ranges::single_view(W{1}), allocator};
+    error <<= n * kWordBSize;
+    error -= divisor;
+    error <<= n * kWordBSize;
+    error -= (divisor * inv_hi) << (lo * kWordBSize);
+
+    // x error / B^2n ~ (B^hi + inv_hi) (error / B^n) / B^hi
+    BigInt error_top = error >> (n * kWordBSize);
+    BigInt step = error_top + ((error_top * inv_hi) >> (hi * kWordBSize));
+    BigInt inv = (inv_hi << (lo * kWordBSize)) + step;
+
+    // Remainder of B^2n - 1 by v, it is close to [0, v) after iteration
+    BigInt remainder = error - divisor * step - BigInt{1};
+    while (remainder < BigInt{}) {
+      remainder += divisor;
+      inv -= BigInt{1};
+    }
+    while (remainder >= divisor) {
+      remainder -= divisor;
+      inv += BigInt{1};
+    }
+
+    Scratch ret(n, 0, allocator);
+    std::ranges::copy(inv.ToView(), ret.begin());
+    return ret;
+  }
+  return Scratch(allocator);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::NewtonDivide(
+    std::span<W> u, std::span<const W> v, std::span<const W> inv_words,
+    std::span<W> q, detail::ResourceAllocator<W> allocator) noexcept {
+  const std::size_t n = v.size();
+  ASSERT(2 * n <= cap);
+
+  const BigInt inv{inv_words, allocator};
+  const BigInt divisor{v, allocator};
+
+  // Quotient is computed by blocks of at most n words starting from the top
+  // one. Estimation u_top + u_top inv / B^n is never greater than actual
+  // quotient and at most 3 lesser than it
+  for (std::size_t end = q.size(); end > 0;) {
+    std::size_t begin = end > n ? end - n : 0;
+    std::span<W> block = u.subspan(begin, end - begin + n);
+    std::span<W> block_q = q.subspan(begin, end - begin);
+
+    BigInt u_top{block.subspan(n), allocator};
+    BigInt estimation = u_top * inv;
+    estimation >>= n * kWordBSize;
+    estimation += u_top;
+    std::ranges::fill(block_q, W{0});
+    std::ranges::copy(estimation.ToView(), block_q.begin());
+
+    estimation *= divisor;
+    bool borrow = Kernel::Sub(block, estimation.ToView());
+    ASSERT(!borrow, "Quotient is overestimated");
+    while (!Kernel::Sub(block, v)) {
+      Kernel::AddWord(block_q, 1);
+    }
+    Kernel::Add(block, v);
+
+    end = begin;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void
+BigInt<cap, W, DW>::Divide(std::span<W> u, std::span<const W> v,
+                           std::span<W> q,
+                           detail::ResourceAllocator<W> allocator) noexcept {
+  ASSERT(v.size() >= 2);
+  Divide(u, v, Kernel::Reciprocal(v.back()), q, allocator);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void
+BigInt<cap, W, DW>::Divide(std::span<W> u, std::span<const W> v, W v_inv,
+                           std::span<W> q,
+                           detail::ResourceAllocator<W> allocator) noexcept {
+  const std::size_t n = v.size();
+  const std::size_t k = q.size();
+  if constexpr (cap < 2 * kBurnikelThreshold) {
+    Kernel::KnuthDivide(u, v, v_inv, q);
+  } else {
+    if (n < kBurnikelThreshold || k < kBurnikelThreshold) {
+      Kernel::KnuthDivide(u, v, v_inv, q);
+      return;
+    }
+
+    WithCapacity<cap>(u.size(), [&]<std::size_t small_cap>() {
+      using SmallInt = BigInt<small_cap, W, DW>;
+      if (n >= kNewtonThreshold && k >= 4 * n) {
+        SmallInt::NewtonDivide(
+            u, v, SmallInt::NewtonReciprocal(v, allocator), q, allocator);
+      } else {
+        SmallInt::BurnikelDivide(u, v, v_inv, q, allocator);
+      }
+    });
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr typename BigInt<cap, W, DW>::Scratch
+BigInt<cap, W, DW>::DivisorReciprocal(
+    std::span<const W> v, detail::ResourceAllocator<W> allocator) noexcept {
+  return WithCapacity<kDoubleCapacity>(
+      2 * v.size(), [v, allocator]<std::size_t small_cap>() {
+        return BigInt<small_cap, W, DW>::NewtonReciprocal(v, allocator);
+      });
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::DivideByReciprocal(
+    std::span<W> u, std::span<const W> v, std::span<const W> inv,
+    std::span<W> q, detail::ResourceAllocator<W> allocator) noexcept {
+  WithCapacity<kDoubleCapacity>(2 * v.size(), [&]<std::size_t small_cap>() {
+    BigInt<small_cap, W, DW>::NewtonDivide(u, v, inv, q, allocator);
+  });
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UDivModByRange(
+    const RandomAccessRange<W> auto& range, BigInt* quotient,
+    BigInt* remainder) const noexcept {
+  if (auto cmp = UCompare(range); cmp < 0) {
+    if (remainder != nullptr && remainder != this) {
+      remainder->UResetBinary(ToView());
+    }
+    if (quotient != nullptr) {
+      quotient->UResetBinary(std::ranges::single_view(W{0}));
+    }
+    return;
+  } else if (cmp == 0) {
+    if (remainder != nullptr) {
+      remainder->UResetBinary(std::ranges::single_view(W{0}));
+    }
+    if (quotient != nullptr) {
+      quotient->UResetBinary(std::ranges::single_view(W{1}));
+    }
+    return;
+  } else if (std::ranges::size(range) == 1) {
+    const W divisor = *std::ranges::begin(range);
+    W remainder_word;
+    if (quotient == nullptr) {
+      remainder_word = UModByWord(divisor);
+    } else {
+      if (quotient != this) {
+        quotient->UResetBinary(ToView());
+      }
+      remainder_word = quotient->UDivByWord(divisor);
+    }
+    if (remainder != nullptr) {
+      remainder->UResetBinary(std::ranges::single_view(remainder_word));
+    }
+    return;
+  }
+
+  auto range_data = std::ranges::begin(range);
+  const std::size_t n = std::ranges::size(range);
+
+  // Normalize divisor, so that its most significant bit is set
+  const int shift = std::countl_zero(range_data[n - 1]);
+  Scratch vn(n, ScratchAllocator());
+  for (std::size_t i = 0; i < n; ++i) {
+    vn[i] = static_cast<W>(range_data[i] << shift);
+    if (shift != 0 && i > 0) {
+      vn[i] |= static_cast<W>(range_data[i - 1] >> (kWordBSize - shift));
+    }
+  }
+
+  UDivModByNormalized(vn, shift, quotient, remainder,
+                      [this](std::span<W> u, std::span<const W> v,
+                             std::span<W> q) {
+                        Divide(u, v, q, ScratchAllocator());
+                      });
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UDivModByNormalized(
+    std::span<const W> vn, int shift, BigInt* quotient, BigInt* remainder,
+    auto&& divide) const noexcept {
+  const std::size_t n = vn.size();
+
+  // Quotient of (this << shift) / vn is the same
+  Scratch un(words_count + 1, 0, ScratchAllocator());
+  for (std::size_t i = 0; i < words_count; ++i) {
+    un[i] = static_cast<W>(un[i] | static_cast<W>(binary[i] << shift));
+    if (shift != 0) {
+      un[i + 1] = static_cast<W>(binary[i] >> (kWordBSize - shift));
+    }
+  }
+
+  // Quotient words are still produced by Divide, but without quotient they
+  // go to scratch buffer instead of BigInt
+  const std::size_t quotient_wc = words_count - n + 1;
+  Scratch scratch(ScratchAllocator());
+  std::span<W> q;
+  if (quotient != nullptr) {
+    quotient->Grow(quotient_wc);
+    q = std::span<W>{quotient->binary.data(), quotient_wc};
+  } else {
+    scratch.resize(quotient_wc);
+    q = scratch;
+  }
+  divide(un, vn, q);
+
+  if (quotient != nullptr) {
+    quotient->words_count = quotient_wc;
+    if (quotient_wc > 1 && q[quotient_wc - 1] == 0) {
+      quotient->words_count -= 1;
+    }
+  }
+
+  if (remainder != nullptr) {
+    // Remainder is un[0 .. n) >> shift
+    std::size_t remainder_wc = 1;
+    for (std::size_t i = 0; i < n; ++i) {
+      un[i] = static_cast<W>(un[i] >> shift);
+      if (shift != 0) {
+        un[i] |= static_cast<W>(un[i + 1] << (kWordBSize - shift));
+      }
+      if (un[i] != 0) {
+        remainder_wc = i + 1;
+      }
+    }
+    remainder->UResetBinary(std::span<const W>{un.data(), remainder_wc});
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t rhs_cap>
+constexpr void
+BigInt<cap, W, DW>::DivModInner(const BigInt<rhs_cap, W, DW>& rhs,
+                                BigInt* quotient,
+                                BigInt* remainder) const noexcept {
+  ASSERT(!rhs.IsZero(), "Division by zero");
+  const bool quotient_is_positive = is_positive ^ !rhs.is_positive;
+  const bool remainder_is_positive = rhs.is_positive;
+
+  if (rhs.IsPowerOf2()) {
+    // Remainder is computed first, unless it overwrites this
+    const std::size_t shift = rhs.BitWidth() - 1;
+    auto truncate = [this, shift](BigInt* remainder) {
+      const std::size_t wc = std::min(words_count, shift / kWordBSize + 1);
+      remainder->UResetBinary(std::ranges::take_view(ToView(), wc));
+      if (wc * kWordBSize > shift) {
+        W& top = remainder->binary[wc - 1];
+        top = static_cast<W>(top & ((W{1} << (shift % kWordBSize)) - 1));
+      }
+      while (remainder->words_count > 1 &&
+             remainder->binary[remainder->words_count - 1] == 0) {
+        remainder->words_count -= 1;
+      }
+    };
+    auto shift_right = [this, shift](BigInt* quotient) {
+      if (quotient != this) {
+        quotient->UResetBinary(ToView());
+      }
+      *quotient >>= shift;
+    };
+
+    if (remainder == this) {
+      if (quotient != nullptr) {
+        shift_right(quotient);
+      }
+      truncate(remainder);
+    } else {
+      if (remainder != nullptr) {
+        truncate(remainder);
+      }
+      if (quotient != nullptr) {
+        shift_right(quotient);
+      }
+    }
+  } else {
+    UDivModByRange(rhs.ToView(), quotient, remainder);
+  }
+
+  if (quotient != nullptr) {
+    quotient->is_positive = quotient_is_positive;
+  }
+  if (remainder != nullptr) {
+    remainder->is_positive = remainder_is_positive;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::HenselSubProduct(
+    std::span<W> u, std::size_t k, std::span<const W> d,
+    detail::ResourceAllocator<W> allocator) noexcept {
+  BigInt prod{u.first(k), allocator};
+  prod.UMulByRange(d.first(std::min(d.size(), u.size())));
+  if (prod.words_count > k) {
+    auto high = prod.ToView().subspan(k);
+    Kernel::Sub(u.subspan(k), high.first(std::min(u.size() - k, high.size())));
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::HenselDivide(
+    std::span<W> u, std::span<const W> d, W d_inv,
+    detail::ResourceAllocator<W> allocator) noexcept {
+  const std::size_t k = u.size();
+  if constexpr (cap >= 2 * kHenselThreshold) {
+    if (k >= kHenselThreshold && d.size() >= kHenselThreshold) {
+      const std::size_t lo = k / 2;
+      HenselDivide(u.first(lo), d, d_inv, allocator);
+
+      const std::size_t max_size = lo + std::min(d.size(), k);
+      WithCapacity<kDoubleCapacity>(max_size, [&]<std::size_t small_cap>() {
+        BigInt<small_cap, W, DW>::HenselSubProduct(u, lo, d, allocator);
+      });
+
+      HenselDivide(u.subspan(lo), d, d_inv, allocator);
+      return;
+    }
+  }
+
+  Kernel::HenselBasecase(u, d, d_inv);
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::UDivExactByRange(
+    const RandomAccessRange<W> auto& range) noexcept {
+  if (auto cmp = UCompare(range); cmp <= 0) {
+    UResetBinary(std::ranges::single_view(W{cmp == 0}));
+    return;
+  }
+
+  // Trailing zeros are removed from both, so that divisor is odd
+  auto range_data = std::ranges::begin(range);
+  std::size_t zeros = 0;
+  while (range_data[zeros / kWordBSize] == 0) {
+    zeros += kWordBSize;
+  }
+  zeros += std::countr_zero(range_data[zeros / kWordBSize]);
+  *this >>= zeros;
+
+  const std::size_t word_offset = zeros / kWordBSize;
+  const int shift = zeros % kWordBSize;
+  Scratch d(std::ranges::size(range) - word_offset, ScratchAllocator());
+  for (std::size_t i = 0; i < d.size(); ++i) {
+    d[i] = static_cast<W>(range_data[i + word_offset] >> shift);
+    if (shift != 0 && i + word_offset + 1 < std::ranges::size(range)) {
+      d[i] |= static_cast<W>(range_data[i + word_offset + 1]
+                             << (kWordBSize - shift));
+    }
+  }
+  while (d.size() > 1 && d.back() == 0) {
+    d.pop_back();
+  }
+
+  if (d.size() > words_count) {
+    UResetBinary(std::ranges::single_view(W{0}));
+    return;
+  }
+
+  // Quotient is lesser than B^k, so it's enough to find it modulo B^k
+  const std::size_t k = words_count - d.size() + 1;
+  Grow(words_count);
+  HenselDivide(std::span<W>{binary.data(), k}, d, Kernel::InverseModB(d[0]),
+               ScratchAllocator());
+
+  words_count = k;
+  while (words_count > 1 && binary[words_count - 1] == 0) {
+    words_count -= 1;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::DivExact(const BigInt& rhs) noexcept {
+  ASSERT(!rhs.IsZero(), "Division by zero");
+#ifndef NDEBUG
+  const BigInt divident{*this, ScratchAllocator()};
+#endif
+
+  const bool rhs_is_positive = rhs.is_positive;
+  if (rhs.IsPowerOf2()) {
+    *this >>= rhs.BitWidth() - 1;
+  } else if (&rhs == this) {
+    UResetBinary(std::ranges::single_view(W{1}));
+  } else {
+    UDivExactByRange(rhs.ToView());
+  }
+  is_positive ^= !rhs_is_positive;
+
+  assert(*this * (&rhs == this ? divident : rhs) == divident &&
+         "Division is not exact");
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator/=(const BigInt& rhs) noexcept {
+  DivModInner(rhs, this, nullptr);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator%=(const BigInt& rhs) noexcept {
+  DivModInner(rhs, nullptr, this);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t rhs_cap>
+  requires(rhs_cap != cap)
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator%=(const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  DivModInner(rhs, nullptr, this);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::operator~() const noexcept {
+  static_assert(!kInfInt, "Can't negate unbound BigInt");
+  BigInt ret = *this;
+  std::span<W> words{ret.binary};
+  Kernel::Not(words.first(words_count));
+  std::ranges::fill(words.subspan(words_count), static_cast<W>(~W{0}));
+  ret.words_count = std::max<std::size_t>(Kernel::SignificantSize(words), 1);
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator^=(const BigInt& other) noexcept {
+  const std::size_t common = std::min(words_count, other.words_count);
+  Grow(other.words_count);
+  std::span<W> words{binary.data(), std::max(words_count, other.words_count)};
+  std::span<const W> other_words{other.binary.data(), other.words_count};
+  Kernel::Xor(words.first(common), other_words.first(common));
+  std::ranges::copy(other_words.subspan(common), words.begin() + common);
+  words_count = std::max<std::size_t>(Kernel::SignificantSize(words), 1);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator|=(const BigInt& other) noexcept {
+  const std::size_t common = std::min(words_count, other.words_count);
+  Grow(other.words_count);
+  std::span<W> words{binary.data(), common};
+  std::span<const W> other_words{other.binary.data(), other.words_count};
+  Kernel::Or(words, other_words.first(common));
+  std::ranges::copy(other_words.subspan(common), words.end());
+  words_count = std::max(words_count, other.words_count);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>&
+BigInt<cap, W, DW>::operator&=(const BigInt& other) noexcept {
+  const std::size_t common = std::min(words_count, other.words_count);
+  Grow(common);
+  std::span<W> words{binary.data(), common};
+  Kernel::And(words, std::span<const W>{other.binary.data(), common});
+  words_count = std::max<std::size_t>(Kernel::SignificantSize(words), 1);
+  return *this;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>::BigInt(
+    std::pmr::memory_resource& resource) noexcept
+  requires(kInfInt)
+    : binary{&resource}
+    , words_count{1}
+    , is_positive{true} {}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>::BigInt(
+    const BigInt& other, std::pmr::memory_resource& resource) noexcept
+  requires(kInfInt)
+    : BigInt{other, detail::ResourceAllocator<W>{&resource}} {}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr std::pmr::memory_resource*
+BigInt<cap, W, DW>::Resource() const noexcept {
+  return ScratchAllocator().resource();
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr detail::ResourceAllocator<W>
+BigInt<cap, W, DW>::ScratchAllocator() const noexcept {
+  if constexpr (kInfInt) {
+    return binary.get_allocator();
+  } else {
+    return {};
   }
+}
 
-  BigInt remainder{r};
-  remainder.UMulByRange(range);
-  remainder.USubRange(ToView());
+template<std::size_t cap, typename W, typename DW>
+template<std::size_t n>
+constexpr std::array<BigInt<cap, W, DW>, n>
+BigInt<cap, W, DW>::Zeros(detail::ResourceAllocator<W> allocator) noexcept {
+  return [allocator]<std::size_t... i>(std::index_sequence<i...>) {
+    return std::array<BigInt, n>{((void)i, BigInt{allocator})...};
+  }(std::make_index_sequence<n>{});
+}
 
-  UResetBinary(std::ranges::single_view(r));
-  return remainder;
+template<std::size_t cap, typename W, typename DW>
+constexpr std::size_t BigInt<cap, W, DW>::Capacity() const noexcept {
+  if constexpr (kInfInt) {
+    return binary.size();
+  } else {
+    return cap;
+  }
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::UDivByRange(
-    const RandomAccessRange<W> auto& range) noexcept {
-  if (auto cmp = UCompare(range); cmp < 0) {
-    BigInt remainder{ToView()};
-    UResetBinary(std::ranges::single_view(W{0}));
-    return remainder;
-  } else if (cmp == 0) {
-    UResetBinary(std::ranges::single_view(W{1}));
-    return BigInt{};
-  } else if (std::ranges::size(range) == 1) {
-    return UDivByWord(*std::ranges::begin(range));
-  } else if (BitWidth() - RangeBitWidth(range) < kWordBSize) {
-    return UDivBySameRange(range);
+constexpr void BigInt<cap, W, DW>::Reserve(std::size_t words) noexcept {
+  if constexpr (kInfInt) {
+    if (words > binary.size()) {
+      detail::SmallWords<W> reserved(words, binary.get_allocator());
+      std::ranges::copy(binary, reserved.begin());
+      binary = std::move(reserved);
+    }
   } else {
-    BigInt r, q; // remainder and quotient
-    for (std::size_t i = 0; i < words_count; ++i) {
-      q <<= kWordBSize;
-      r <<= kWordBSize;
-      r.UAddRange(std::ranges::single_view(binary[words_count - 1 - i]));
-      if (auto cmp = r.UCompare(range); cmp >= 0) {
-        BigInt tmp = r;
-        r.UResetBinary(tmp.UDivBySameRange(range).ToView());
-        ASSERT(tmp.words_count == 1);
-        q.UAddRange(tmp.ToView());
+    ASSERT(words <= cap, "Capacity is fixed");
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::ShrinkToFit() noexcept {
+  if constexpr (kInfInt) {
+    if (binary.size() > words_count) {
+      detail::SmallWords<W> fit(words_count, binary.get_allocator());
+      std::copy_n(binary.begin(), words_count, fit.begin());
+      binary = std::move(fit);
+    }
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void BigInt<cap, W, DW>::Grow(std::size_t words) noexcept {
+  if constexpr (kInfInt) {
+    if (words > binary.size() || binary.IsShared()) [[unlikely]] {
+      Reallocate(words);
+    }
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr detail::SmallWords<W>
+BigInt<cap, W, DW>::Grow(std::size_t words,
+                         std::span<const W>& range) noexcept {
+  detail::SmallWords<W> old;
+  if constexpr (kInfInt) {
+    if (words > binary.size() || binary.IsShared()) [[unlikely]] {
+      // Inline words are overwritten, so range is moved to their copy
+      const W* const begin = std::as_const(binary).data();
+      bool aliased = false;
+      if (std::is_constant_evaluated()) {
+        // Pointers to unrelated objects can't be ordered there
+        for (std::size_t i = 0; i < binary.size() && !range.empty(); ++i) {
+          aliased = aliased || begin + i == range.data();
+        }
+      } else {
+        aliased = std::less_equal{}(begin, range.data()) &&
+                  std::less{}(range.data(), begin + binary.size());
+      }
+      Reallocate(words, &old);
+      if (aliased) {
+        range = {old.data() + (range.data() - begin), range.size()};
       }
     }
-    UResetBinary(q.ToView());
-    return r;
   }
+  return old;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator/=(const BigInt& rhs) noexcept {
-  ASSERT(!rhs.IsZero(), "Division by zero");
-  is_positive ^= !rhs.is_positive;
-  if (rhs.IsPowerOf2()) {
-    *this >>= rhs.BitWidth() - 1;
-  } else {
-    UDivByRange(rhs.ToView());
+constexpr void
+BigInt<cap, W, DW>::Reallocate(std::size_t words,
+                               detail::SmallWords<W>* old) noexcept {
+  if constexpr (kInfInt) {
+    const std::size_t size = binary.size();
+    detail::SmallWords<W> grown(
+        words > size ? std::max(words, 2 * size) : size,
+        binary.get_allocator());
+    std::ranges::copy(std::as_const(binary), grown.begin());
+    if (old != nullptr) {
+      *old = std::move(binary);
+    }
+    binary = std::move(grown);
   }
-  return *this;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator%=(const BigInt& rhs) noexcept {
-  ASSERT(!rhs.IsZero(), "Division by zero");
-  is_positive = rhs.is_positive;
-  UResetBinary(UDivByRange(rhs.ToView()).ToView());
-  return *this;
+constexpr bool BigInt<cap, W, DW>::RangeIsZero(
+    const RandomAccessRange<W> auto& range) noexcept {
+  return std::ranges::size(range) == 1 && *std::ranges::begin(range) == 0;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> BigInt<cap, W, DW>::operator~() const noexcept {
-  static_assert(!kInfInt, "Can't negate unbound BigInt");
-  BigInt ret = *this;
-  if (ret.words_count < cap) {
-    for (std::size_t i = 0; i < ret.words_count; ++i) {
-      ret.binary[i] = ~ret.binary[i];
+constexpr bool BigInt<cap, W, DW>::IsZero() const noexcept {
+  return RangeIsZero(ToView());
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr bool BigInt<cap, W, DW>::IsPowerOf2() const noexcept {
+  if (IsZero() || Kernel::SignificantSize(std::span<const W>{
+                       binary.data(), words_count - 1}) != 0) {
+    return false;
+  }
+  return (binary[words_count - 1] & (binary[words_count - 1] - 1)) == 0;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr bool BigInt<cap, W, DW>::AreDigits(std::string_view str,
+                                             W base) noexcept {
+  std::size_t i = 0;
+  if (base == 10) {
+    // Every byte of 8 chars at once should be in [0x30, 0x39]
+    constexpr uint64_t kHigh = 0xF0F0F0F0F0F0F0F0;
+    constexpr uint64_t kZeros = 0x3030303030303030;
+    for (; i + 8 <= str.size(); i += 8) {
+      uint64_t chars = 0;
+      for (std::size_t j = 0; j < 8; ++j) {
+        chars |= static_cast<uint64_t>(static_cast<uint8_t>(str[i + j]))
+                 << (8 * j);
+      }
+      if ((chars & kHigh) != kZeros ||
+          ((chars + 0x0606060606060606) & kHigh) != kZeros) {
+        return false;
+      }
     }
-    for (std::size_t i = ret.words_count; i < cap; ++i) {
-      ret.binary[i] = ~0;
+  }
+
+  for (; i < str.size(); ++i) {
+    if (kDigitValues[static_cast<uint8_t>(str[i])] >= base) {
+      return false;
     }
-    ret.words_count = cap;
-  } else {
-    ret.words_count = 1;
-    for (std::size_t i = 0; i < cap; ++i) {
-      std::size_t idx = cap - 1;
-      if ((ret.binary[idx] = ~ret.binary[idx]) && ret.words_count == 1) {
-        ret.words_count = idx + 1;
+  }
+  return true;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr uint64_t BigInt<cap, W, DW>::ChunkValue(std::string_view digits,
+                                                  W base) noexcept {
+  uint64_t ret = 0;
+  std::size_t i = 0;
+  if (base == 10) {
+    // 8 digits are combined pairwise in 3 steps, first digit is the lowest
+    // byte
+    for (; i + 8 <= digits.size(); i += 8) {
+      uint64_t chars = 0;
+      for (std::size_t j = 0; j < 8; ++j) {
+        chars |= static_cast<uint64_t>(static_cast<uint8_t>(digits[i + j]))
+                 << (8 * j);
       }
+      chars -= 0x3030303030303030;
+      chars = (chars * 10 + (chars >> 8)) & 0x00FF00FF00FF00FF;
+      chars = (chars * 100 + (chars >> 16)) & 0x0000FFFF0000FFFF;
+      chars = (chars * 10000 + (chars >> 32)) & 0x00000000FFFFFFFF;
+      ret = ret * 100000000 + chars;
     }
   }
 
+  for (; i < digits.size(); ++i) {
+    ret = ret * base + kDigitValues[static_cast<uint8_t>(digits[i])];
+  }
   return ret;
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator^=(const BigInt& other) noexcept {
-  if (words_count != other.words_count) {
-    std::size_t iters = std::min(words_count, other.words_count);
-    for (std::size_t i = 0; i < iters; ++i) {
-      binary[i] ^= other.binary[i];
-    }
+constexpr void BigInt<cap, W, DW>::UParseDigits(
+    std::string_view digits, W base, std::size_t chunk_digits,
+    std::span<const BigInt> powers) noexcept {
+  // Low part takes chunk_digits 2^level digits, high part is not empty
+  std::size_t level = powers.size() - 1;
+  while (level > 0 && (chunk_digits << level) >= digits.size()) {
+    level -= 1;
+  }
 
-    if (words_count < other.words_count) {
-      for (std::size_t i = iters; i < other.words_count; ++i) {
-        binary[i] = other.binary[i];
-      }
-      words_count = other.words_count;
+  if (level == 0 || digits.size() < kFromStringThreshold * chunk_digits) {
+    // Every multiplication by word adds chunk_digits digits
+    const W chunk = powers[0].binary[0];
+    std::size_t head = digits.size() % chunk_digits;
+    if (head == 0) {
+      head = chunk_digits;
     }
-  } else {
-    for (std::size_t i = 0; i < words_count; ++i) {
-      binary[i] ^= other.binary[i];
+
+    UResetBinary(std::ranges::single_view(
+        static_cast<W>(ChunkValue(digits.substr(0, head), base))));
+    for (std::size_t i = head; i < digits.size(); i += chunk_digits) {
+      UMulByShortRange(std::ranges::single_view(chunk));
+      UAddRange(std::ranges::single_view(static_cast<W>(
+          ChunkValue(digits.substr(i, chunk_digits), base))));
     }
+    return;
   }
+
+  const std::size_t low_digits = chunk_digits << level;
+  BigInt low{ScratchAllocator()};
+  low.UParseDigits(digits.substr(digits.size() - low_digits), base,
+                   chunk_digits, powers);
+  UParseDigits(digits.substr(0, digits.size() - low_digits), base,
+               chunk_digits, powers);
+  UMulByRange(powers[level].ToView());
+  UAddRange(low.ToView());
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator|=(const BigInt& other) noexcept {
-  std::size_t iters = std::min(words_count, other.words_count);
-  for (std::size_t i = 0; i < iters; ++i) {
-    binary[i] |= other.binary[i];
+constexpr std::errc
+BigInt<cap, W, DW>::UParsePowerOf2Digits(std::string_view digits,
+                                         int bits) noexcept {
+  const std::size_t bits_count =
+      (digits.size() - 1) * bits +
+      std::bit_width(kDigitValues[static_cast<uint8_t>(digits[0])]);
+  if constexpr (!kInfInt) {
+    if (bits_count > cap * kWordBSize) {
+      return std::errc::value_too_large;
+    }
   }
 
-  if (iters < other.words_count) {
-    for (std::size_t i = iters; i < other.words_count; ++i) {
-      binary[i] = other.binary[i];
+  Scratch words((bits_count + kWordBSize - 1) / kWordBSize, ScratchAllocator());
+  auto set_bits = [&words](std::size_t pos, uint64_t value) {
+    std::size_t offset = pos % kWordBSize;
+    for (std::size_t i = pos / kWordBSize; value != 0; ++i) {
+      words[i] |= static_cast<W>(value << offset);
+      const std::size_t written = kWordBSize - offset;
+      value = written < 64 ? value >> written : 0;
+      offset = 0;
+    }
+  };
+
+  std::size_t i = 0;
+  if (bits == 4) {
+    // 8 hex digits at once, first digit is the lowest byte
+    for (; i + 8 <= digits.size(); i += 8) {
+      uint64_t chars = 0;
+      for (std::size_t j = 0; j < 8; ++j) {
+        chars |= static_cast<uint64_t>(static_cast<uint8_t>(
+                     digits[digits.size() - i - 8 + j]))
+                 << (8 * j);
+      }
+      // Letters have 0x40 bit set and value of low nibble plus 9
+      chars = (chars & 0x0F0F0F0F0F0F0F0F) +
+              ((chars >> 6) & 0x0101010101010101) * 9;
+      // Nibbles are combined pairwise in 3 steps
+      chars = ((chars & 0x0F000F000F000F00) >> 8) |
+              ((chars & 0x000F000F000F000F) << 4);
+      chars = ((chars & 0x00FF000000FF0000) >> 16) |
+              ((chars & 0x000000FF000000FF) << 8);
+      chars = ((chars & 0x0000FFFF00000000) >> 32) |
+              ((chars & 0x000000000000FFFF) << 16);
+      set_bits(4 * i, chars);
     }
-    words_count = other.words_count;
+  }
+  for (; i < digits.size(); ++i) {
+    set_bits(bits * i,
+             kDigitValues[static_cast<uint8_t>(digits[digits.size() - 1 - i])]);
   }
 
-  return *this;
+  UResetBinary(words);
+  return std::errc{};
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW>&
-BigInt<cap, W, DW>::operator&=(const BigInt& other) noexcept {
-  const std::size_t iterations = std::min(words_count, other.words_count);
-  words_count = 1;
-  for (std::size_t i = 0; i < iterations; ++i) {
-    if ((binary[i] &= other.binary[i])) {
-      words_count = i + 1;
+constexpr std::errc BigInt<cap, W, DW>::Parse(std::string_view str) noexcept {
+  is_positive = true;
+  if (!str.empty() && str[0] == '-') {
+    is_positive = false;
+    str.remove_prefix(1);
+  }
+
+  W base = 10;
+  if (str.starts_with("0b")) {
+    base = 2;
+  } else if (str.starts_with("0o")) {
+    base = 8;
+  } else if (str.starts_with("0x")) {
+    base = 16;
+  }
+  if (base != 10) {
+    str.remove_prefix(2);
+  }
+
+  std::basic_string<char, std::char_traits<char>,
+                    detail::ResourceAllocator<char>>
+      without_separators(ScratchAllocator());
+  if (str.find('\'') != std::string_view::npos) {
+    std::ranges::copy_if(str, std::back_inserter(without_separators),
+                         [](char c) { return c != '\''; });
+    str = without_separators;
+  }
+
+  if (str.empty() || !AreDigits(str, base)) {
+    return std::errc::invalid_argument;
+  }
+
+  str.remove_prefix(std::min(str.find_first_not_of('0'), str.size() - 1));
+  if (std::has_single_bit(base)) {
+    return UParsePowerOf2Digits(str, std::countr_zero(base));
+  }
+
+  // Largest power of base, which fits into word
+  W chunk = base;
+  std::size_t chunk_digits = 1;
+  while (chunk <= kMaxWord / base) {
+    chunk = static_cast<W>(chunk * base);
+    chunk_digits += 1;
+  }
+
+  // Number of n digits is in [base^(n - 1), base^n)
+  std::string_view last_digit;
+  if constexpr (!kInfInt) {
+    // Only decimal numbers get here
+    const double bits_per_digit = 3.321928094887362;
+    const double max_bits = static_cast<double>(cap * kWordBSize);
+    if (static_cast<double>(str.size() - 1) * bits_per_digit >= max_bits) {
+      return std::errc::value_too_large;
+    } else if (static_cast<double>(str.size()) * bits_per_digit > max_bits) {
+      last_digit = str.substr(str.size() - 1);
+      str.remove_suffix(1);
     }
   }
-  return *this;
+
+  std::vector<BigInt, detail::ResourceAllocator<BigInt>> powers(
+      ScratchAllocator());
+  powers.push_back(BigInt{std::ranges::single_view(chunk), ScratchAllocator()});
+  if (str.size() >= kFromStringThreshold * chunk_digits) {
+    while ((chunk_digits << powers.size()) < str.size()) {
+      powers.push_back(BigInt{powers.back().ToView(), ScratchAllocator()});
+      powers.back().Square();
+    }
+  }
+  UParseDigits(str, base, chunk_digits, powers);
+
+  if constexpr (!kInfInt) {
+    if (!last_digit.empty()) {
+      // Number may not fit only by the last digit
+      BigInt<cap + 1, W, DW> wide{ToView()};
+      wide.UMulByShortRange(std::ranges::single_view(base));
+      wide.UAddRange(std::ranges::single_view(
+          static_cast<W>(ChunkValue(last_digit, base))));
+      if (wide.words_count > cap) {
+        return std::errc::value_too_large;
+      }
+      UResetBinary(wide.ToView());
+    }
+  }
+  return std::errc{};
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr bool BigInt<cap, W, DW>::RangeIsZero(
-    const RandomAccessRange<W> auto& range) noexcept {
-  return std::ranges::size(range) == 1 && *std::ranges::begin(range) == 0;
+constexpr uint64_t BigInt<cap, W, DW>::BitsAt(std::size_t pos,
+                                              std::size_t len) const noexcept {
+  ASSERT(len <= 32);
+  uint64_t ret = 0;
+  std::size_t offset = pos % kWordBSize;
+  for (std::size_t i = pos / kWordBSize, got = 0;
+       got < len && i < words_count; ++i) {
+    ret |= (static_cast<uint64_t>(binary[i]) >> offset) << got;
+    got += kWordBSize - offset;
+    offset = 0;
+  }
+  return ret & ((uint64_t{1} << len) - 1);
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr bool BigInt<cap, W, DW>::IsZero() const noexcept {
-  return RangeIsZero(ToView());
+constexpr void
+BigInt<cap, W, DW>::AppendPowerOf2Digits(std::string& str,
+                                         int bits) const noexcept {
+  constexpr std::string_view alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+  // Digit i is written to str[end - 1 - i]
+  const std::size_t digits = (BitWidth() + bits - 1) / bits;
+  str.resize(str.size() + digits);
+  const std::size_t end = str.size();
+
+  std::size_t i = 0;
+  if (bits == 4) {
+    // 8 hex digits at once, lowest nibble goes to the lowest byte
+    for (; i + 8 <= digits; i += 8) {
+      uint64_t nibbles = BitsAt(4 * i, 32);
+      nibbles = (nibbles | (nibbles << 16)) & 0x0000FFFF0000FFFF;
+      nibbles = (nibbles | (nibbles << 8)) & 0x00FF00FF00FF00FF;
+      nibbles = (nibbles | (nibbles << 4)) & 0x0F0F0F0F0F0F0F0F;
+      // Nibbles above 9 are moved from after '9' to 'A'
+      const uint64_t letters =
+          ((nibbles + 0x0606060606060606) >> 4) & 0x0101010101010101;
+      const uint64_t chars = nibbles + 0x3030303030303030 + letters * 7;
+      for (std::size_t j = 0; j < 8; ++j) {
+        str[end - 1 - i - j] = static_cast<char>(chars >> (8 * j));
+      }
+    }
+  }
+  for (; i < digits; ++i) {
+    str[end - 1 - i] = alphabet[BitsAt(bits * i, bits)];
+  }
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr bool BigInt<cap, W, DW>::IsPowerOf2() const noexcept {
-  if (IsZero()) {
-    return false;
-  }
-  for (std::size_t i = 0; i < words_count - 1; ++i) {
-    if (binary[i]) {
-      return false;
+constexpr void BigInt<cap, W, DW>::AppendDigits(
+    std::string& str, W base, std::size_t chunk_digits,
+    std::span<const BigInt> powers, std::size_t level,
+    std::size_t digits) const noexcept {
+  constexpr std::string_view alphabet = "0123456789"
+                                        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+  if (level == 0 || words_count < kToStringThreshold) {
+    // Every division by word extracts chunk_digits digits
+    const W chunk = powers[0].binary[0];
+    const std::size_t begin = str.size();
+    BigInt copy{ToView(), ScratchAllocator()};
+    while (!copy.IsZero()) {
+      W digits_chunk = copy.UDivByWord(chunk);
+      for (std::size_t i = 0; i < chunk_digits; ++i) {
+        str.push_back(alphabet[digits_chunk % base]);
+        digits_chunk /= base;
+      }
+    }
+
+    if (digits == 0) {
+      while (str.size() > begin + 1 && str.back() == '0') {
+        str.pop_back();
+      }
+    } else {
+      ASSERT(str.size() - begin <= digits);
+      str.resize(begin + digits, '0');
     }
+    std::reverse(str.begin() + begin, str.end());
+    return;
   }
-  return (binary[words_count - 1] & (binary[words_count - 1] - 1)) == 0;
+
+  // Leading zeros are not printed, so unpadded number is split only if it
+  // has high part
+  if (digits == 0 && UCompare(powers[level - 1].ToView()) < 0) {
+    AppendDigits(str, base, chunk_digits, powers, level - 1, 0);
+    return;
+  }
+
+  // Low part has exactly chunk_digits 2^(level - 1) digits
+  auto [quotient, remainder] = Zeros<2>(ScratchAllocator());
+  UDivModByRange(powers[level - 1].ToView(), &quotient, &remainder);
+  const std::size_t low_digits = chunk_digits << (level - 1);
+  quotient.AppendDigits(str, base, chunk_digits, powers, level - 1,
+                        digits == 0 ? 0 : digits - low_digits);
+  remainder.AppendDigits(str, base, chunk_digits, powers, level - 1,
+                         low_digits);
 }
 
 template<std::size_t cap, typename W, typename DW>
 constexpr std::string BigInt<cap, W, DW>::ToString(W base) const noexcept {
-  constexpr std::string_view alphabet = "0123456789"
-                                        "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
   ASSERT(base >= 2 && base <= 36);
   if (IsZero()) {
     return "0";
   }
 
   std::string ret;
-  BigInt copy{ToView()};
+  if (!is_positive) {
+    ret.push_back('-');
+  }
+  if (std::has_single_bit(base)) {
+    AppendPowerOf2Digits(ret, std::countr_zero(base));
+    return ret;
+  }
 
-  while (!copy.IsZero()) {
-    ret.push_back(alphabet.at(copy.UDivByWord(base)));
+  // Largest power of base, which fits into word
+  W chunk = base;
+  std::size_t chunk_digits = 1;
+  while (chunk <= kMaxWord / base) {
+    chunk = static_cast<W>(chunk * base);
+    chunk_digits += 1;
   }
 
-  if (!is_positive) {
-    ret.push_back('-');
+  // Digits are at most bits / floor(log2(base)), top chunk is written with
+  // leading zeros before they are removed
+  ret.reserve(ret.size() + BitWidth() / (std::bit_width(base) - 1) +
+              chunk_digits + 1);
+
+  // Squares are taken while they may be lesser than this
+  std::vector<BigInt, detail::ResourceAllocator<BigInt>> powers(
+      ScratchAllocator());
+  powers.push_back(BigInt{std::ranges::single_view(chunk), ScratchAllocator()});
+  if (words_count >= kToStringThreshold) {
+    while (2 * powers.back().words_count <= words_count) {
+      powers.push_back(BigInt{powers.back().ToView(), ScratchAllocator()});
+      powers.back().Square();
+    }
   }
-  std::reverse(ret.begin(), ret.end());
+
+  AppendDigits(ret, base, chunk_digits, powers, powers.size(), 0);
   return ret;
 }
 
@@ -882,7 +2739,11 @@ constexpr uint64_t BigInt<cap, W, DW>::ToUint() const noexcept {
   ASSERT(words_count * kWordBSize <= 64);
   uint64_t ret = 0;
   for (W w : std::ranges::reverse_view(ToView())) {
-    ret = (ret << kWordBSize) + w;
+    if constexpr (kWordBSize < 64) {
+      ret = (ret << kWordBSize) + w;
+    } else {
+      ret = static_cast<uint64_t>(w);
+    }
   }
   return ret;
 }
@@ -912,15 +2773,9 @@ constexpr std::strong_ordering BigInt<cap, W, DW>::UCompare(
     return cmp;
   }
 
-  auto range_data = std::ranges::begin(range);
-  for (std::size_t i = 0; i < words_count; ++i) {
-    if (auto cmp =
-            binary[words_count - 1 - i] <=> range_data[words_count - 1 - i];
-        cmp != 0) {
-      return cmp;
-    }
-  }
-  return std::strong_ordering::equal;
+  return Kernel::Compare(
+      std::span<const W>{binary.data(), words_count},
+      std::span<const W>{std::ranges::data(range), words_count});
 }
 
 template<std::size_t cap, typename W, typename DW>
@@ -936,6 +2791,9 @@ BigInt<cap, W, DW>::operator<=>(const BigInt& rhs) const noexcept {
     return std::strong_ordering::equal;
   } else if (is_positive ^ rhs.is_positive) {
     return is_positive <=> rhs.is_positive;
+  } else if (words_count <= 2 && rhs.words_count <= 2) {
+    const auto cmp = UDoubleWord() <=> rhs.UDoubleWord();
+    return is_positive ? cmp : 0 <=> cmp;
   } else if (auto cmp = UCompare(rhs.ToView()); is_positive) {
     return cmp;
   } else {
@@ -943,19 +2801,44 @@ BigInt<cap, W, DW>::operator<=>(const BigInt& rhs) const noexcept {
   }
 }
 
+namespace detail {
+
+// Copy of InfInt in its resource, results of free operators are computed
+// in the copy of lhs. Other copies are plain
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW>
+CopyWithResource(const BigInt<cap, W, DW>& value) noexcept {
+  if constexpr (cap == std::numeric_limits<std::size_t>::max()) {
+    if (std::pmr::memory_resource* resource = value.Resource()) {
+      return BigInt<cap, W, DW>{value, *resource};
+    }
+  }
+  return value;
+}
+
+} // namespace detail
+
 // Arithmetic opeartors
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator+(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator+(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret += rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator+(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs += rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator+(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return BigInt<cap, W, DW>{std::forward<T>(rhs)} + lhs;
+  return lhs + BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -966,17 +2849,25 @@ constexpr BigInt<cap, W, DW> operator+(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator-(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator-(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret -= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator-(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs -= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator-(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return -(BigInt<cap, W, DW>{std::forward<T>(rhs)} - lhs);
+  return lhs - BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -987,17 +2878,25 @@ constexpr BigInt<cap, W, DW> operator-(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator*(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator*(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret *= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator*(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs *= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator*(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return BigInt<cap, W, DW>{std::forward<T>(rhs)} * lhs;
+  return lhs * BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -1008,18 +2907,25 @@ constexpr BigInt<cap, W, DW> operator*(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator/(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator/(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret /= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator/(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs /= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
-constexpr BigInt<cap, W, DW> operator/(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator/(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  lhs /= BigInt<cap, W, DW>{std::forward<T>(rhs)};
-  return lhs;
+  return lhs / BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -1030,18 +2936,25 @@ constexpr BigInt<cap, W, DW> operator/(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator%(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator%(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret %= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator%(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs %= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
-constexpr BigInt<cap, W, DW> operator%(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator%(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  lhs %= BigInt<cap, W, DW>{std::forward<T>(rhs)};
-  return lhs;
+  return lhs % BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -1051,18 +2964,70 @@ constexpr BigInt<cap, W, DW> operator%(T&& lhs,
   return BigInt<cap, W, DW>{std::forward<T>(lhs)} % rhs;
 }
 
+// Operands of different capacities. Sum and difference get the wider one,
+// remainder gets the one of divisor, which always fits it
+template<std::size_t lhs_cap, std::size_t rhs_cap, typename W, typename DW>
+  requires(lhs_cap != rhs_cap)
+constexpr BigInt<std::max(lhs_cap, rhs_cap), W, DW>
+operator+(const BigInt<lhs_cap, W, DW>& lhs,
+          const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  if constexpr (lhs_cap > rhs_cap) {
+    BigInt<lhs_cap, W, DW> ret = detail::CopyWithResource(lhs);
+    ret += rhs;
+    return ret;
+  } else {
+    BigInt<rhs_cap, W, DW> ret = rhs;
+    ret += lhs;
+    return ret;
+  }
+}
+
+template<std::size_t lhs_cap, std::size_t rhs_cap, typename W, typename DW>
+  requires(lhs_cap != rhs_cap)
+constexpr BigInt<std::max(lhs_cap, rhs_cap), W, DW>
+operator-(const BigInt<lhs_cap, W, DW>& lhs,
+          const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  if constexpr (lhs_cap > rhs_cap) {
+    BigInt<lhs_cap, W, DW> ret = detail::CopyWithResource(lhs);
+    ret -= rhs;
+    return ret;
+  } else {
+    BigInt<rhs_cap, W, DW> ret{lhs.ToView(), lhs.is_positive};
+    ret -= rhs;
+    return ret;
+  }
+}
+
+template<std::size_t lhs_cap, std::size_t rhs_cap, typename W, typename DW>
+  requires(lhs_cap != rhs_cap)
+constexpr BigInt<rhs_cap, W, DW>
+operator%(const BigInt<lhs_cap, W, DW>& lhs,
+          const BigInt<rhs_cap, W, DW>& rhs) noexcept {
+  BigInt<lhs_cap, W, DW> remainder = detail::CopyWithResource(lhs);
+  remainder %= rhs;
+  return BigInt<rhs_cap, W, DW>{remainder.ToView(), remainder.is_positive};
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator&(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret &= rhs;
+  return ret;
+}
+
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator&(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator&(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs &= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator&(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return BigInt<cap, W, DW>{std::forward<T>(rhs)} & lhs;
+  return lhs & BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -1073,17 +3038,25 @@ constexpr BigInt<cap, W, DW> operator&(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator|(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator|(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret |= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator|(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs |= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator|(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return BigInt<cap, W, DW>{std::forward<T>(rhs)} | lhs;
+  return lhs | BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
@@ -1094,17 +3067,25 @@ constexpr BigInt<cap, W, DW> operator|(T&& lhs,
 }
 
 template<std::size_t cap, typename W, typename DW>
-constexpr BigInt<cap, W, DW> operator^(BigInt<cap, W, DW> lhs,
+constexpr BigInt<cap, W, DW> operator^(const BigInt<cap, W, DW>& lhs,
+                                       const BigInt<cap, W, DW>& rhs) noexcept {
+  BigInt<cap, W, DW> ret = detail::CopyWithResource(lhs);
+  ret ^= rhs;
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr BigInt<cap, W, DW> operator^(BigInt<cap, W, DW>&& lhs,
                                        const BigInt<cap, W, DW>& rhs) noexcept {
   lhs ^= rhs;
-  return lhs;
+  return std::move(lhs);
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
   requires(!IsBigInt<std::remove_cvref_t<T>>::value)
 constexpr BigInt<cap, W, DW> operator^(const BigInt<cap, W, DW>& lhs,
                                        T&& rhs) noexcept {
-  return BigInt<cap, W, DW>{std::forward<T>(rhs)} ^ lhs;
+  return lhs ^ BigInt<cap, W, DW>{std::forward<T>(rhs)};
 }
 
 template<std::size_t cap, typename W, typename DW, typename T>
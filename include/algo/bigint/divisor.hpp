@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algo/assert.hpp>
+#include <algo/bigint.hpp>
+#include <algo/bigint/kernel.hpp>
+
+#include <bit>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace algo {
+
+/*
+ * Divisor with precomputed normalization shift and reciprocal for repeated
+ * division by the same value. Möller-Granlund reciprocal of the top word
+ * divides by single word divisors and estimates quotient words of Knuth's
+ * algorithm D for longer ones, also at the leaves of Burnikel-Ziegler
+ * recursion. Long divisors use Barrett reduction by reciprocal computed
+ * once by Newton iteration
+ */
+template<std::size_t words_capacity, typename Word = uint32_t,
+         typename DoubleWord = uint64_t>
+class BigIntDivisor {
+  using Int = BigInt<words_capacity, Word, DoubleWord>;
+  using Kernel = detail::BigIntKernel<Word, DoubleWord>;
+
+  static constexpr std::size_t kWordBSize = std::numeric_limits<Word>::digits;
+
+public:
+  constexpr explicit BigIntDivisor(Int divisor) noexcept;
+
+  // Same as x % divisor and DivMod(x, divisor)
+  constexpr Int Mod(const Int& x) const noexcept;
+  constexpr std::pair<Int, Int> DivMod(const Int& x) const noexcept;
+
+  constexpr const Int& Divisor() const noexcept;
+
+private:
+  constexpr void DivModInner(const Int& x, Int* quotient,
+                             Int* remainder) const noexcept;
+
+  Int divisor_;
+  int shift_;
+
+  // Single word divisor normalized
+  Word word_;
+  // Kernel::Reciprocal of the top word of normalized divisor
+  Word word_inv_;
+
+  // Long divisor normalized and its reciprocal, if Barrett reduction is used
+  typename Int::Scratch normalized_;
+  typename Int::Scratch inv_;
+};
+
+// Implementation
+template<std::size_t cap, typename W, typename DW>
+constexpr BigIntDivisor<cap, W, DW>::BigIntDivisor(Int divisor) noexcept
+    : divisor_{std::move(divisor)}
+    , normalized_(divisor_.ScratchAllocator()) {
+  ASSERT(!divisor_.IsZero(), "Division by zero");
+
+  auto view = divisor_.ToView();
+  const std::size_t n = divisor_.words_count;
+  shift_ = std::countl_zero(view[n - 1]);
+
+  if (n == 1) {
+    word_ = static_cast<W>(view[0] << shift_);
+    word_inv_ = Kernel::Reciprocal(word_);
+    return;
+  }
+
+  normalized_.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    normalized_[i] = static_cast<W>(view[i] << shift_);
+    if (shift_ != 0 && i > 0) {
+      normalized_[i] |= static_cast<W>(view[i - 1] >> (kWordBSize - shift_));
+    }
+  }
+  word_inv_ = Kernel::Reciprocal(normalized_.back());
+
+  // Below Newton threshold multiplication is not faster than schoolbook
+  // division even with reciprocal given
+  if (n >= Int::kNewtonThreshold) {
+    inv_ = Int::DivisorReciprocal(normalized_, divisor_.ScratchAllocator());
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr void
+BigIntDivisor<cap, W, DW>::DivModInner(const Int& x, Int* quotient,
+                                       Int* remainder) const noexcept {
+  const bool quotient_is_positive = x.is_positive ^ !divisor_.is_positive;
+
+  if (auto cmp = x.UCompare(divisor_.ToView()); cmp < 0) {
+    if (remainder != nullptr) {
+      *remainder = x;
+    }
+    if (quotient != nullptr) {
+      *quotient = Int{};
+    }
+  } else if (cmp == 0) {
+    if (remainder != nullptr) {
+      *remainder = Int{};
+    }
+    if (quotient != nullptr) {
+      *quotient = Int{1};
+    }
+  } else if (normalized_.empty()) {
+    W remainder_word;
+    if (quotient != nullptr) {
+      *quotient = x;
+      remainder_word = quotient->UDivByWord(word_, word_inv_, shift_);
+    } else {
+      remainder_word = x.UModByWord(word_, word_inv_, shift_);
+    }
+    if (remainder != nullptr) {
+      *remainder = Int{std::ranges::single_view(remainder_word)};
+    }
+  } else if (inv_.empty()) {
+    x.UDivModByNormalized(normalized_, shift_, quotient, remainder,
+                          [this, &x](std::span<W> u, std::span<const W> v,
+                                     std::span<W> q) {
+                            Int::Divide(u, v, word_inv_, q,
+                                        x.ScratchAllocator());
+                          });
+  } else {
+    x.UDivModByNormalized(normalized_, shift_, quotient, remainder,
+                          [this, &x](std::span<W> u, std::span<const W> v,
+                                     std::span<W> q) {
+                            Int::DivideByReciprocal(u, v, inv_, q,
+                                                    x.ScratchAllocator());
+                          });
+  }
+
+  if (quotient != nullptr) {
+    quotient->is_positive = quotient_is_positive;
+  }
+  if (remainder != nullptr) {
+    remainder->is_positive = divisor_.is_positive;
+  }
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr typename BigIntDivisor<cap, W, DW>::Int
+BigIntDivisor<cap, W, DW>::Mod(const Int& x) const noexcept {
+  Int ret{x.ScratchAllocator()};
+  DivModInner(x, nullptr, &ret);
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr std::pair<typename BigIntDivisor<cap, W, DW>::Int,
+                    typename BigIntDivisor<cap, W, DW>::Int>
+BigIntDivisor<cap, W, DW>::DivMod(const Int& x) const noexcept {
+  std::pair<Int, Int> ret{Int{x.ScratchAllocator()},
+                          Int{x.ScratchAllocator()}};
+  DivModInner(x, &ret.first, &ret.second);
+  return ret;
+}
+
+template<std::size_t cap, typename W, typename DW>
+constexpr const typename BigIntDivisor<cap, W, DW>::Int&
+BigIntDivisor<cap, W, DW>::Divisor() const noexcept {
+  return divisor_;
+}
+
+} // namespace algo
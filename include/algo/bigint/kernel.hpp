@@ -0,0 +1,629 @@
+#pragma once
+
+#include <algo/assert.hpp>
+#include <algo/bigint/x86_64.hpp>
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace algo::detail {
+
+/*
+ * Arithmetic on little endian word spans, which doesn't depend on BigInt
+ * capacity. Every BigInt with the same Word shares these instantiations,
+ * BigInt itself only keeps storage and picks algorithms
+ */
+template<typename Word, typename DoubleWord>
+struct BigIntKernel {
+  static constexpr std::size_t kWordBSize = std::numeric_limits<Word>::digits;
+  static constexpr Word kMaxWord = std::numeric_limits<Word>::max();
+
+  // Minimal words count of the shortest operand for Karatsuba recursion
+  static constexpr std::size_t kKaratsubaThreshold = 32;
+  // Same for squaring, its basecase computes half of the products only
+  static constexpr std::size_t kKaratsubaSquareThreshold = 48;
+
+  // r = a + b (r = a - b) for a and b of r.size() words, r may be the
+  // same as a or b. Returns carry (borrow)
+  static constexpr bool AddN(std::span<Word> r, std::span<const Word> a,
+                             std::span<const Word> b) noexcept;
+  static constexpr bool SubN(std::span<Word> r, std::span<const Word> a,
+                             std::span<const Word> b) noexcept;
+  // r = a * b (r += a * b, r -= a * b) for a of r.size() words, r may be
+  // the same as a. Returns high word (word to be borrowed above r)
+  static constexpr Word Mul1(std::span<Word> r, std::span<const Word> a,
+                             Word b) noexcept;
+  static constexpr Word AddMul1(std::span<Word> r, std::span<const Word> a,
+                                Word b) noexcept;
+  static constexpr Word SubMul1(std::span<Word> r, std::span<const Word> a,
+                                Word b) noexcept;
+
+  // r &= a (r |= a, r ^= a) for a of r.size() words, r = ~r
+  static constexpr void And(std::span<Word> r,
+                            std::span<const Word> a) noexcept;
+  static constexpr void Or(std::span<Word> r, std::span<const Word> a) noexcept;
+  static constexpr void Xor(std::span<Word> r,
+                            std::span<const Word> a) noexcept;
+  static constexpr void Not(std::span<Word> r) noexcept;
+  template<BitOp op>
+  static constexpr void Bitwise(std::span<Word> r,
+                                std::span<const Word> a) noexcept;
+
+  // Compares a and b of the same size from the most significant words
+  static constexpr std::strong_ordering
+  Compare(std::span<const Word> a, std::span<const Word> b) noexcept;
+  // Words count of a without leading zeros, zero for zero a
+  static constexpr std::size_t
+  SignificantSize(std::span<const Word> a) noexcept;
+
+  // lhs += rhs (lhs -= rhs), rhs should not be longer than lhs.
+  // Returns carry (borrow) out of lhs
+  static constexpr bool Add(std::span<Word> lhs,
+                            std::span<const Word> rhs) noexcept;
+  static constexpr bool Sub(std::span<Word> lhs,
+                            std::span<const Word> rhs) noexcept;
+  static constexpr bool AddWord(std::span<Word> lhs, Word rhs) noexcept;
+  static constexpr bool SubWord(std::span<Word> lhs, Word rhs) noexcept;
+
+  // r = a * b, r has a.size() + b.size() words
+  static constexpr void BasecaseMul(std::span<Word> r, std::span<const Word> a,
+                                    std::span<const Word> b) noexcept;
+  // r = a * a, r has 2 a.size() words
+  static constexpr void BasecaseSquare(std::span<Word> r,
+                                       std::span<const Word> a) noexcept;
+  // Same by Karatsuba recursion, temporaries of every level are taken from
+  // scratch of KaratsubaScratchSize(max(a.size(), b.size())) words
+  static constexpr void KaratsubaMul(std::span<Word> r, std::span<const Word> a,
+                                     std::span<const Word> b,
+                                     std::span<Word> scratch) noexcept;
+  // r = a * a, r has 2 a.size() words
+  static constexpr void KaratsubaSquare(std::span<Word> r,
+                                        std::span<const Word> a,
+                                        std::span<Word> scratch) noexcept;
+  static constexpr std::size_t KaratsubaScratchSize(std::size_t n) noexcept;
+
+  // floor((B^2 - 1) / d) - B for B = 2^kWordBSize and d >= B / 2
+  static constexpr Word Reciprocal(Word d) noexcept;
+  // (u1 B + u0) / d for u1 < d, d >= B / 2 and v = Reciprocal(d).
+  // Remainder is stored in u0
+  static constexpr Word UDiv2By1(Word u1, Word& u0, Word d, Word v) noexcept;
+  // d^-1 mod B for odd d
+  static constexpr Word InverseModB(Word d) noexcept;
+
+  // u /= rhs for rhs = d >> shift and v = Reciprocal(d), returns remainder
+  static constexpr Word DivByWord(std::span<Word> u, Word d, Word v,
+                                  int shift) noexcept;
+  static constexpr Word ModByWord(std::span<const Word> u, Word d, Word v,
+                                  int shift) noexcept;
+
+  // Divides u by v, which is at least two words long and has its most
+  // significant bit set. u has q.size() + v.size() words and its top
+  // v.size() words should be lesser than v. Quotient is written into q,
+  // remainder is left in the lowest v.size() words of u
+  static constexpr void KnuthDivide(std::span<Word> u, std::span<const Word> v,
+                                    std::span<Word> q) noexcept;
+  // Same with v_inv = Reciprocal(v.back()) given
+  static constexpr void KnuthDivide(std::span<Word> u, std::span<const Word> v,
+                                    Word v_inv, std::span<Word> q) noexcept;
+
+  // Quotient of u by odd d modulo B^u.size() with d_inv = InverseModB(d[0])
+  // replaces u, words are found one by one from the lowest
+  static constexpr void HenselBasecase(std::span<Word> u,
+                                       std::span<const Word> d,
+                                       Word d_inv) noexcept;
+};
+
+// Implementation
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::AddN(std::span<W> r, std::span<const W> a,
+                                         std::span<const W> b) noexcept {
+  ASSERT(a.size() == r.size() && b.size() == r.size());
+  if constexpr (X86Kernels<W>::kAddSub) {
+    if (!std::is_constant_evaluated()) {
+      return X86Kernels<W>::AddN(r.data(), a.data(), b.data(), r.size());
+    }
+  }
+
+  W carry = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    DW sum = static_cast<DW>(a[i]) + b[i] + carry;
+    r[i] = static_cast<W>(sum);
+    carry = static_cast<W>(sum >> kWordBSize);
+  }
+  return carry != 0;
+}
+
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::SubN(std::span<W> r, std::span<const W> a,
+                                         std::span<const W> b) noexcept {
+  ASSERT(a.size() == r.size() && b.size() == r.size());
+  if constexpr (X86Kernels<W>::kAddSub) {
+    if (!std::is_constant_evaluated()) {
+      return X86Kernels<W>::SubN(r.data(), a.data(), b.data(), r.size());
+    }
+  }
+
+  W borrow = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    DW diff = static_cast<DW>(a[i]) - b[i] - borrow;
+    r[i] = static_cast<W>(diff);
+    borrow = static_cast<W>(diff >> kWordBSize) & 1;
+  }
+  return borrow != 0;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::Mul1(std::span<W> r, std::span<const W> a,
+                                      W b) noexcept {
+  ASSERT(a.size() == r.size());
+  if constexpr (X86Kernels<W>::kMul) {
+    if (!std::is_constant_evaluated() && X86Kernels<W>::HasMulx()) {
+      return X86Kernels<W>::Mul1(r.data(), a.data(), r.size(), b);
+    }
+  }
+
+  W carry = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    DW prod = static_cast<DW>(a[i]) * b + carry;
+    r[i] = static_cast<W>(prod);
+    carry = static_cast<W>(prod >> kWordBSize);
+  }
+  return carry;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::AddMul1(std::span<W> r, std::span<const W> a,
+                                         W b) noexcept {
+  ASSERT(a.size() == r.size());
+  if constexpr (X86Kernels<W>::kMul) {
+    if (!std::is_constant_evaluated() && X86Kernels<W>::HasMulx()) {
+      return X86Kernels<W>::AddMul1(r.data(), a.data(), r.size(), b);
+    }
+  }
+
+  W carry = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    DW prod = static_cast<DW>(a[i]) * b + r[i] + carry;
+    r[i] = static_cast<W>(prod);
+    carry = static_cast<W>(prod >> kWordBSize);
+  }
+  return carry;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::SubMul1(std::span<W> r, std::span<const W> a,
+                                         W b) noexcept {
+  ASSERT(a.size() == r.size());
+  if constexpr (X86Kernels<W>::kMul) {
+    if (!std::is_constant_evaluated() && X86Kernels<W>::HasMulx()) {
+      return X86Kernels<W>::SubMul1(r.data(), a.data(), r.size(), b);
+    }
+  }
+
+  // Carry never overflows, since high word of a[i] * b + carry is B - 1
+  // only if its low word is zero
+  W carry = 0;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    DW prod = static_cast<DW>(a[i]) * b + carry;
+    W sub = static_cast<W>(prod);
+    W lhs = r[i];
+    r[i] = static_cast<W>(lhs - sub);
+    carry = static_cast<W>((prod >> kWordBSize) + (lhs < sub));
+  }
+  return carry;
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::And(std::span<W> r,
+                                        std::span<const W> a) noexcept {
+  Bitwise<BitOp::kAnd>(r, a);
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::Or(std::span<W> r,
+                                       std::span<const W> a) noexcept {
+  Bitwise<BitOp::kOr>(r, a);
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::Xor(std::span<W> r,
+                                        std::span<const W> a) noexcept {
+  Bitwise<BitOp::kXor>(r, a);
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::Not(std::span<W> r) noexcept {
+  Bitwise<BitOp::kNot>(r, r);
+}
+
+template<typename W, typename DW>
+template<BitOp op>
+constexpr void BigIntKernel<W, DW>::Bitwise(std::span<W> r,
+                                            std::span<const W> a) noexcept {
+  ASSERT(a.size() == r.size());
+  std::size_t i = 0;
+  if constexpr (X86Kernels<W>::kSimd) {
+    if (!std::is_constant_evaluated()) {
+      i = X86Kernels<W>::template Bitwise<op>(r.data(), a.data(), r.size());
+    }
+  }
+
+  for (; i < r.size(); ++i) {
+    if constexpr (op == BitOp::kAnd) {
+      r[i] &= a[i];
+    } else if constexpr (op == BitOp::kOr) {
+      r[i] |= a[i];
+    } else if constexpr (op == BitOp::kXor) {
+      r[i] ^= a[i];
+    } else {
+      r[i] = static_cast<W>(~r[i]);
+    }
+  }
+}
+
+template<typename W, typename DW>
+constexpr std::strong_ordering
+BigIntKernel<W, DW>::Compare(std::span<const W> a,
+                             std::span<const W> b) noexcept {
+  ASSERT(a.size() == b.size());
+  std::size_t n = a.size();
+  // The most significant words differ most of the time
+  if (n == 0 || a[n - 1] != b[n - 1]) {
+    return n == 0 ? std::strong_ordering::equal : a[n - 1] <=> b[n - 1];
+  }
+
+  if constexpr (X86Kernels<W>::kSimd) {
+    if (!std::is_constant_evaluated()) {
+      n = X86Kernels<W>::EqualTop(a.data(), b.data(), n - 1);
+    }
+  }
+  while (n-- > 0) {
+    if (a[n] != b[n]) {
+      return a[n] <=> b[n];
+    }
+  }
+  return std::strong_ordering::equal;
+}
+
+template<typename W, typename DW>
+constexpr std::size_t
+BigIntKernel<W, DW>::SignificantSize(std::span<const W> a) noexcept {
+  std::size_t n = a.size();
+  if constexpr (X86Kernels<W>::kSimd) {
+    if (!std::is_constant_evaluated()) {
+      n = X86Kernels<W>::EqualTop(a.data(), nullptr, n);
+    }
+  }
+  while (n > 0 && a[n - 1] == 0) {
+    --n;
+  }
+  return n;
+}
+
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::Add(std::span<W> lhs,
+                                        std::span<const W> rhs) noexcept {
+  ASSERT(rhs.size() <= lhs.size());
+
+  bool carry = AddN(lhs.first(rhs.size()), lhs.first(rhs.size()), rhs);
+  for (std::size_t i = rhs.size(); carry && i < lhs.size(); ++i) {
+    lhs[i] = static_cast<W>(lhs[i] + 1);
+    carry = lhs[i] == 0;
+  }
+  return carry;
+}
+
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::Sub(std::span<W> lhs,
+                                        std::span<const W> rhs) noexcept {
+  ASSERT(rhs.size() <= lhs.size());
+
+  bool borrow = SubN(lhs.first(rhs.size()), lhs.first(rhs.size()), rhs);
+  for (std::size_t i = rhs.size(); borrow && i < lhs.size(); ++i) {
+    borrow = lhs[i] == 0;
+    lhs[i] = static_cast<W>(lhs[i] - 1);
+  }
+  return borrow;
+}
+
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::AddWord(std::span<W> lhs,
+                                            W rhs) noexcept {
+  return Add(lhs, std::span<const W>{&rhs, 1});
+}
+
+template<typename W, typename DW>
+constexpr bool BigIntKernel<W, DW>::SubWord(std::span<W> lhs,
+                                            W rhs) noexcept {
+  return Sub(lhs, std::span<const W>{&rhs, 1});
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::BasecaseMul(std::span<W> r,
+                                                std::span<const W> a,
+                                                std::span<const W> b) noexcept {
+  r[a.size()] = Mul1(r.first(a.size()), a, b[0]);
+  for (std::size_t i = 1; i < b.size(); ++i) {
+    r[i + a.size()] = AddMul1(r.subspan(i, a.size()), a, b[i]);
+  }
+}
+
+template<typename W, typename DW>
+constexpr void
+BigIntKernel<W, DW>::BasecaseSquare(std::span<W> r,
+                                    std::span<const W> a) noexcept {
+  // Products of different words are summed once and doubled
+  const std::size_t n = a.size();
+  r[0] = 0;
+  r[2 * n - 1] = 0;
+  if (n > 1) {
+    r[n] = Mul1(r.subspan(1, n - 1), a.subspan(1), a[0]);
+    for (std::size_t i = 1; i + 1 < n; ++i) {
+      r[n + i] = AddMul1(r.subspan(2 * i + 1, n - 1 - i), a.subspan(i + 1),
+                         a[i]);
+    }
+    AddN(r, r, r);
+  }
+
+  W carry = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    DW square = static_cast<DW>(a[i]) * a[i];
+    DW low = static_cast<DW>(r[2 * i]) + static_cast<W>(square) + carry;
+    r[2 * i] = static_cast<W>(low);
+    DW high = static_cast<DW>(r[2 * i + 1]) + (square >> kWordBSize) +
+              (low >> kWordBSize);
+    r[2 * i + 1] = static_cast<W>(high);
+    carry = static_cast<W>(high >> kWordBSize);
+  }
+}
+
+template<typename W, typename DW>
+constexpr std::size_t
+BigIntKernel<W, DW>::KaratsubaScratchSize(std::size_t n) noexcept {
+  std::size_t ret = 0;
+  while (n >= kKaratsubaThreshold) {
+    // Halves of n words are at most m words, their sum is m + 1 words
+    const std::size_t m = (n + 1) / 2;
+    ret += 5 * m + 5;
+    n = m + 1;
+  }
+  return ret;
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::KaratsubaMul(
+    std::span<W> r, std::span<const W> a, std::span<const W> b,
+    std::span<W> scratch) noexcept {
+  if (a.size() < b.size()) {
+    std::swap(a, b);
+  }
+  if (b.size() < kKaratsubaThreshold) {
+    BasecaseMul(r, a, b);
+    return;
+  }
+
+  const std::size_t m = (a.size() + 1) / 2;
+  if (b.size() <= m) {
+    // b has no high half, a is multiplied by halves
+    std::span<W> high = scratch.first(a.size() - m + b.size());
+    KaratsubaMul(r.first(m + b.size()), a.first(m), b, scratch);
+    KaratsubaMul(high, a.subspan(m), b, scratch.subspan(high.size()));
+    std::ranges::fill(r.subspan(m + b.size()), W{0});
+    Add(r.subspan(m), high);
+    return;
+  }
+
+  // (a1 B^m + a0) (b1 B^m + b0) =
+  //     a1 b1 B^2m + ((a0 + a1) (b0 + b1) - a0 b0 - a1 b1) B^m + a0 b0
+  std::span<W> a_sum = scratch.first(m + 1);
+  std::span<W> b_sum = scratch.subspan(m + 1, m + 1);
+  std::span<W> mix = scratch.subspan(2 * m + 2, 2 * m + 2);
+  std::span<W> rest = scratch.subspan(4 * m + 4);
+
+  std::ranges::copy(a.first(m), a_sum.begin());
+  a_sum[m] = Add(a_sum.first(m), a.subspan(m));
+  std::ranges::copy(b.first(m), b_sum.begin());
+  b_sum[m] = Add(b_sum.first(m), b.subspan(m));
+
+  KaratsubaMul(r.first(2 * m), a.first(m), b.first(m), rest);
+  KaratsubaMul(r.subspan(2 * m), a.subspan(m), b.subspan(m), rest);
+  KaratsubaMul(mix, a_sum, b_sum, rest);
+  Sub(mix, r.first(2 * m));
+  Sub(mix, r.subspan(2 * m));
+
+  // Middle term is less than B^max(a.size(), b.size())
+  std::span<W> r_mid = r.subspan(m);
+  Add(r_mid, mix.first(std::min(mix.size(), r_mid.size())));
+}
+
+template<typename W, typename DW>
+constexpr void
+BigIntKernel<W, DW>::KaratsubaSquare(std::span<W> r, std::span<const W> a,
+                                     std::span<W> scratch) noexcept {
+  if (a.size() < kKaratsubaSquareThreshold) {
+    BasecaseSquare(r, a);
+    return;
+  }
+
+  // (a1 B^m + a0)^2 = a1^2 B^2m + (a0^2 + a1^2 - (a0 - a1)^2) B^m + a0^2
+  const std::size_t m = (a.size() + 1) / 2;
+  std::span<W> mix = scratch.first(2 * m + 1);
+  std::span<W> diff_square = scratch.subspan(2 * m + 1, 2 * m);
+  std::span<W> diff = scratch.subspan(4 * m + 1, m);
+  std::span<W> rest = scratch.subspan(5 * m + 1);
+
+  std::ranges::copy(a.first(m), diff.begin());
+  if (Sub(diff, a.subspan(m))) {
+    // Negative difference is made positive from its two's complement
+    for (W& word : diff) {
+      word = ~word;
+    }
+    AddWord(diff, 1);
+  }
+
+  KaratsubaSquare(r.first(2 * m), a.first(m), rest);
+  KaratsubaSquare(r.subspan(2 * m), a.subspan(m), rest);
+  KaratsubaSquare(diff_square, diff, rest);
+
+  std::ranges::copy(r.first(2 * m), mix.begin());
+  mix[2 * m] = Add(mix.first(2 * m), r.subspan(2 * m));
+  Sub(mix, diff_square);
+
+  std::span<W> r_mid = r.subspan(m);
+  Add(r_mid, mix.first(std::min(mix.size(), r_mid.size())));
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::Reciprocal(W d) noexcept {
+  return static_cast<W>(
+      ((static_cast<DW>(static_cast<W>(~d)) << kWordBSize) | kMaxWord) / d);
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::UDiv2By1(W u1, W& u0, W d, W v) noexcept {
+  // Möller, Granlund "Improved division by invariant integers", algorithm 4
+  DW q = static_cast<DW>(v) * u1 + ((static_cast<DW>(u1) << kWordBSize) | u0);
+  W q1 = static_cast<W>((q >> kWordBSize) + 1);
+  W q0 = static_cast<W>(q);
+  W r = static_cast<W>(u0 - static_cast<DW>(q1) * d);
+  if (r > q0) {
+    q1 = static_cast<W>(q1 - 1);
+    r = static_cast<W>(r + d);
+  }
+  if (r >= d) [[unlikely]] {
+    q1 = static_cast<W>(q1 + 1);
+    r = static_cast<W>(r - d);
+  }
+  u0 = r;
+  return q1;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::InverseModB(W d) noexcept {
+  // d d = 1 mod 8, every Newton step doubles number of correct bits
+  W inv = d;
+  for (std::size_t bits = 3; bits < kWordBSize; bits *= 2) {
+    W error = static_cast<W>(2 - static_cast<W>(static_cast<DW>(d) * inv));
+    inv = static_cast<W>(static_cast<DW>(inv) * error);
+  }
+  return inv;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::DivByWord(std::span<W> u, W d, W v,
+                                           int shift) noexcept {
+  // Quotient of (u << shift) / d is the same, u is shifted on the fly
+  auto shifted_word = [&](std::size_t idx) -> W {
+    W ret = static_cast<W>(u[idx] << shift);
+    if (shift != 0 && idx > 0) {
+      ret |= u[idx - 1] >> (kWordBSize - shift);
+    }
+    return ret;
+  };
+
+  W remainder = shift == 0 ? 0 : u.back() >> (kWordBSize - shift);
+  for (std::size_t idx = u.size(); idx-- > 0;) {
+    W u0 = shifted_word(idx);
+    u[idx] = UDiv2By1(remainder, u0, d, v);
+    remainder = u0;
+  }
+  return remainder >> shift;
+}
+
+template<typename W, typename DW>
+constexpr W BigIntKernel<W, DW>::ModByWord(std::span<const W> u, W d, W v,
+                                           int shift) noexcept {
+  // Same as DivByWord, but quotient words are dropped
+  W remainder = shift == 0 ? 0 : u.back() >> (kWordBSize - shift);
+  for (std::size_t idx = u.size(); idx-- > 0;) {
+    W u0 = static_cast<W>(u[idx] << shift);
+    if (shift != 0 && idx > 0) {
+      u0 |= u[idx - 1] >> (kWordBSize - shift);
+    }
+    UDiv2By1(remainder, u0, d, v);
+    remainder = u0;
+  }
+  return remainder >> shift;
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::KnuthDivide(std::span<W> u,
+                                                std::span<const W> v,
+                                                std::span<W> q) noexcept {
+  ASSERT(v.size() >= 2);
+  KnuthDivide(u, v, Reciprocal(v.back()), q);
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::KnuthDivide(std::span<W> u,
+                                                std::span<const W> v, W d_inv,
+                                                std::span<W> q) noexcept {
+  const std::size_t n = v.size();
+  ASSERT(n >= 2 && u.size() == q.size() + n);
+
+  const W d = v[n - 1];
+
+  for (std::size_t j = q.size(); j-- > 0;) {
+    // Estimate quotient word by the top words, it is at most 2 greater
+    // than actual one
+    W qhat, rhat = u[j + n - 1];
+    bool rhat_overflow = false;
+    if (u[j + n] >= d) {
+      qhat = kMaxWord;
+      rhat = static_cast<W>(rhat + d);
+      rhat_overflow = rhat < d;
+    } else {
+      qhat = UDiv2By1(u[j + n], rhat, d, d_inv);
+    }
+
+    while (!rhat_overflow &&
+           static_cast<DW>(qhat) * v[n - 2] >
+               ((static_cast<DW>(rhat) << kWordBSize) | u[j + n - 2])) {
+      qhat = static_cast<W>(qhat - 1);
+      rhat = static_cast<W>(rhat + d);
+      rhat_overflow = rhat < d;
+    }
+
+    // u[j .. j + n] -= qhat * v
+    const W carry = SubMul1(u.subspan(j, n), v, qhat);
+    const bool borrow = u[j + n] < carry;
+    u[j + n] = static_cast<W>(u[j + n] - carry);
+
+    // Estimation was 1 greater, add divisor back
+    if (borrow) [[unlikely]] {
+      qhat = static_cast<W>(qhat - 1);
+      Add(u.subspan(j, n + 1), v);
+    }
+
+    q[j] = qhat;
+  }
+}
+
+template<typename W, typename DW>
+constexpr void BigIntKernel<W, DW>::HenselBasecase(std::span<W> u,
+                                                   std::span<const W> d,
+                                                   W d_inv) noexcept {
+  // Quotient word q_i = u_i d^-1 mod B, then q_i d is subtracted from u.
+  // Words of u above k are not needed for quotient modulo B^k
+  const std::size_t k = u.size();
+  for (std::size_t i = 0; i < k; ++i) {
+    const W q = static_cast<W>(static_cast<DW>(u[i]) * d_inv);
+    const std::size_t m = std::min(d.size(), k - i);
+
+    W carry = SubMul1(u.subspan(i, m), d.first(m), q);
+    for (std::size_t j = i + m; j < k && carry != 0; ++j) {
+      W lhs = u[j];
+      u[j] = static_cast<W>(lhs - carry);
+      carry = lhs < carry;
+    }
+
+    u[i] = q;
+  }
+}
+
+} // namespace algo::detail
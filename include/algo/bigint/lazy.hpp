@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algo/bigint.hpp>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace algo {
+
+template<typename Int>
+class LazyFactor;
+template<typename Int, std::size_t terms>
+class LazySum;
+
+/*
+ * Lazy sums of products of BigInt. Lazy(a) * b + Lazy(c) * d - e keeps
+ * references to operands only, value is computed right in destination on
+ * assignment to BigInt. Products are added by AddMul and SubMul, so the
+ * ones of short operands don't need temporaries. Expression is not
+ * supposed to outlive its operands, e.g. to be stored in auto variable
+ */
+template<typename Int>
+class LazyTerm {
+public:
+  constexpr explicit LazyTerm(const Int& factor) noexcept;
+
+  constexpr LazyTerm operator-() const noexcept;
+
+  // acc += this (acc -= this if !positive)
+  constexpr void AddTo(Int& acc, bool positive = true) const noexcept;
+  constexpr bool Aliases(const Int& value) const noexcept;
+
+  constexpr operator Int() const noexcept;
+
+  // Only products of two factors are lazy, the third one is multiplied by
+  // value of the term
+  friend constexpr Int operator*(const LazyTerm& lhs,
+                                 const Int& rhs) noexcept {
+    return Int{lhs} * rhs;
+  }
+  friend constexpr Int operator*(const Int& lhs,
+                                 const LazyTerm& rhs) noexcept {
+    return lhs * Int{rhs};
+  }
+
+  // Operators are not templates and take terms by value, so they are
+  // preferred to the ones of BigInt. Either term of a sum may be BigInt
+  friend constexpr LazySum<Int, 2> operator+(LazyTerm lhs,
+                                             LazyTerm rhs) noexcept {
+    return LazySum<Int, 2>{{lhs, rhs}};
+  }
+  friend constexpr LazySum<Int, 2> operator+(LazyTerm lhs,
+                                             const Int& rhs) noexcept {
+    return LazySum<Int, 2>{{lhs, LazyTerm{rhs}}};
+  }
+  friend constexpr LazySum<Int, 2> operator+(const Int& lhs,
+                                             LazyTerm rhs) noexcept {
+    return LazySum<Int, 2>{{LazyTerm{lhs}, rhs}};
+  }
+  friend constexpr LazySum<Int, 2> operator-(LazyTerm lhs,
+                                             LazyTerm rhs) noexcept {
+    return LazySum<Int, 2>{{lhs, -rhs}};
+  }
+  friend constexpr LazySum<Int, 2> operator-(LazyTerm lhs,
+                                             const Int& rhs) noexcept {
+    return LazySum<Int, 2>{{lhs, -LazyTerm{rhs}}};
+  }
+  friend constexpr LazySum<Int, 2> operator-(const Int& lhs,
+                                             LazyTerm rhs) noexcept {
+    return LazySum<Int, 2>{{LazyTerm{lhs}, -rhs}};
+  }
+
+private:
+  friend class LazyFactor<Int>;
+
+  constexpr LazyTerm Multiply(const Int& factor) const noexcept;
+
+  const Int* first_;
+  const Int* second_ = nullptr;
+  bool is_positive_ = true;
+};
+
+// Term of one factor, as returned by Lazy. Multiplied by BigInt, it gives
+// a lazy product
+template<typename Int>
+class LazyFactor : public LazyTerm<Int> {
+public:
+  constexpr explicit LazyFactor(const Int& factor) noexcept;
+
+  constexpr LazyFactor operator-() const noexcept;
+
+  friend constexpr LazyTerm<Int> operator*(LazyFactor lhs,
+                                           const Int& rhs) noexcept {
+    return lhs.Multiply(rhs);
+  }
+  friend constexpr LazyTerm<Int> operator*(const Int& lhs,
+                                           LazyFactor rhs) noexcept {
+    return rhs.Multiply(lhs);
+  }
+
+private:
+  constexpr LazyTerm<Int> Multiply(const Int& factor) const noexcept;
+};
+
+template<typename Int, std::size_t terms>
+class LazySum {
+public:
+  constexpr explicit LazySum(std::array<LazyTerm<Int>, terms> sum) noexcept;
+
+  constexpr void AddTo(Int& acc, bool positive = true) const noexcept;
+  constexpr bool Aliases(const Int& value) const noexcept;
+
+  constexpr operator Int() const noexcept;
+
+  friend constexpr LazySum<Int, terms + 1>
+  operator+(LazySum lhs, LazyTerm<Int> rhs) noexcept {
+    return lhs.Append(rhs);
+  }
+  friend constexpr LazySum<Int, terms + 1>
+  operator+(LazySum lhs, const Int& rhs) noexcept {
+    return lhs.Append(LazyTerm<Int>{rhs});
+  }
+  friend constexpr LazySum<Int, terms + 1>
+  operator-(LazySum lhs, LazyTerm<Int> rhs) noexcept {
+    return lhs.Append(-rhs);
+  }
+  friend constexpr LazySum<Int, terms + 1>
+  operator-(LazySum lhs, const Int& rhs) noexcept {
+    return lhs.Append(-LazyTerm<Int>{rhs});
+  }
+
+private:
+  constexpr LazySum<Int, terms + 1>
+  Append(const LazyTerm<Int>& term) const noexcept;
+
+  std::array<LazyTerm<Int>, terms> sum_;
+};
+
+template<std::size_t cap, typename W, typename DW>
+constexpr LazyFactor<BigInt<cap, W, DW>>
+Lazy(const BigInt<cap, W, DW>& value) noexcept {
+  return LazyFactor<BigInt<cap, W, DW>>{value};
+}
+
+// Implementation
+template<typename Int>
+constexpr LazyTerm<Int>::LazyTerm(const Int& factor) noexcept
+    : first_{&factor} {}
+
+template<typename Int>
+constexpr LazyTerm<Int> LazyTerm<Int>::operator-() const noexcept {
+  LazyTerm ret = *this;
+  ret.is_positive_ ^= true;
+  return ret;
+}
+
+template<typename Int>
+constexpr LazyTerm<Int>
+LazyTerm<Int>::Multiply(const Int& factor) const noexcept {
+  LazyTerm ret = *this;
+  ret.second_ = &factor;
+  return ret;
+}
+
+template<typename Int>
+constexpr LazyFactor<Int>::LazyFactor(const Int& factor) noexcept
+    : LazyTerm<Int>{factor} {}
+
+template<typename Int>
+constexpr LazyFactor<Int> LazyFactor<Int>::operator-() const noexcept {
+  LazyFactor ret = *this;
+  ret.is_positive_ ^= true;
+  return ret;
+}
+
+template<typename Int>
+constexpr LazyTerm<Int>
+LazyFactor<Int>::Multiply(const Int& factor) const noexcept {
+  return LazyTerm<Int>::Multiply(factor);
+}
+
+template<typename Int>
+constexpr void LazyTerm<Int>::AddTo(Int& acc, bool positive) const noexcept {
+  positive = positive == is_positive_;
+  if (second_ != nullptr && positive) {
+    AddMul(acc, *first_, *second_);
+  } else if (second_ != nullptr) {
+    SubMul(acc, *first_, *second_);
+  } else if (positive) {
+    acc += *first_;
+  } else {
+    acc -= *first_;
+  }
+}
+
+template<typename Int>
+constexpr bool LazyTerm<Int>::Aliases(const Int& value) const noexcept {
+  return first_ == &value || second_ == &value;
+}
+
+template<typename Int>
+constexpr LazyTerm<Int>::operator Int() const noexcept {
+  Int ret;
+  AddTo(ret);
+  return ret;
+}
+
+template<typename Int, std::size_t terms>
+constexpr LazySum<Int, terms>::LazySum(
+    std::array<LazyTerm<Int>, terms> sum) noexcept
+    : sum_{sum} {}
+
+template<typename Int, std::size_t terms>
+constexpr void LazySum<Int, terms>::AddTo(Int& acc,
+                                          bool positive) const noexcept {
+  for (const auto& term : sum_) {
+    term.AddTo(acc, positive);
+  }
+}
+
+template<typename Int, std::size_t terms>
+constexpr bool LazySum<Int, terms>::Aliases(const Int& value) const noexcept {
+  for (const auto& term : sum_) {
+    if (term.Aliases(value)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template<typename Int, std::size_t terms>
+constexpr LazySum<Int, terms>::operator Int() const noexcept {
+  Int ret;
+  AddTo(ret);
+  return ret;
+}
+
+template<typename Int, std::size_t terms>
+constexpr LazySum<Int, terms + 1>
+LazySum<Int, terms>::Append(const LazyTerm<Int>& term) const noexcept {
+  return LazySum<Int, terms + 1>{[&]<std::size_t... i>(
+                                     std::index_sequence<i...>) {
+    return std::array<LazyTerm<Int>, terms + 1>{sum_[i]..., term};
+  }(std::make_index_sequence<terms>{})};
+}
+
+} // namespace algo
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algo/assert.hpp>
+#include <algo/bigint/small_words.hpp>
+#include <algo/concepts.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace algo::detail {
+
+// Transform buffers are allocated like words of the multiplied numbers
+using NttVector = std::vector<uint32_t, ResourceAllocator<uint32_t>>;
+
+/*
+ * Number theoretic transform over Z/pZ for p < 2^30.
+ * Values inside of transform are kept in Montgomery form (R = 2^32)
+ */
+template<uint32_t modulo, uint32_t primitive_root>
+class NttField {
+  static_assert(modulo % 2 == 1 && modulo < (1u << 30));
+
+public:
+  // Longest sequence that can be transformed
+  static constexpr std::size_t kMaxSize = std::size_t{1}
+                                          << std::countr_zero(modulo - 1);
+
+  static constexpr uint32_t Pow(uint32_t base, uint64_t exp) noexcept {
+    uint64_t ret = 1;
+    for (uint64_t b = base % modulo; exp != 0; exp >>= 1, b = b * b % modulo) {
+      if (exp & 1) {
+        ret = ret * b % modulo;
+      }
+    }
+    return static_cast<uint32_t>(ret);
+  }
+
+  static constexpr uint32_t Inverse(uint32_t value) noexcept {
+    return Pow(value, modulo - 2);
+  }
+
+  // Accepts any value < 2^32, not only reduced ones
+  static constexpr uint32_t ToMont(uint32_t value) noexcept {
+    return Reduce(static_cast<uint64_t>(value) * kR2);
+  }
+
+  static constexpr uint32_t MulMont(uint32_t lhs, uint32_t rhs) noexcept {
+    return Reduce(static_cast<uint64_t>(lhs) * rhs);
+  }
+
+  // Cyclic convolution of lhs and rhs, result is stored in lhs.
+  // Both sequences should have the same power of 2 size
+  static constexpr void Convolve(NttVector& lhs, NttVector& rhs) noexcept {
+    ASSERT(lhs.size() == rhs.size());
+    Forward(lhs);
+    Forward(rhs);
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+      lhs[i] = MulMont(lhs[i], rhs[i]);
+    }
+    Backward(lhs);
+  }
+
+  // Cyclic convolution of data with itself
+  static constexpr void Square(NttVector& data) noexcept {
+    Forward(data);
+    for (uint32_t& v : data) {
+      v = MulMont(v, v);
+    }
+    Backward(data);
+  }
+
+private:
+  static constexpr uint32_t kNegInv = [] {
+    uint32_t inv = modulo; // correct for 3 lower bits
+    for (int i = 0; i < 4; ++i) {
+      inv *= 2 - modulo * inv;
+    }
+    return ~inv + 1;
+  }();
+
+  static constexpr uint32_t kR2 =
+      (std::numeric_limits<uint64_t>::max() % modulo + 1) % modulo;
+
+  static constexpr uint32_t kOne = (uint64_t{1} << 32) % modulo;
+
+  // value < modulo * 2^32
+  static constexpr uint32_t Reduce(uint64_t value) noexcept {
+    uint32_t m = static_cast<uint32_t>(value) * kNegInv;
+    uint64_t ret = (value + static_cast<uint64_t>(m) * modulo) >> 32;
+    return static_cast<uint32_t>(ret >= modulo ? ret - modulo : ret);
+  }
+
+  static constexpr void Forward(NttVector& data) noexcept {
+    ASSERT(std::has_single_bit(data.size()) && data.size() <= kMaxSize);
+    for (uint32_t& v : data) {
+      v = ToMont(v);
+    }
+    Transform(data, false);
+  }
+
+  static constexpr void Backward(NttVector& data) noexcept {
+    Transform(data, true);
+
+    // Inverse transform leaves (size * x * R), multiplication by plain
+    // 1 / size removes both factors
+    uint32_t size_inv = Inverse(data.size() % modulo);
+    for (uint32_t& v : data) {
+      v = MulMont(v, size_inv);
+    }
+  }
+
+  static constexpr void Transform(NttVector& data, bool inverse) noexcept {
+    const std::size_t size = data.size();
+    for (std::size_t i = 1, j = 0; i < size; ++i) {
+      std::size_t bit = size >> 1;
+      for (; j & bit; bit >>= 1) {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+        std::swap(data[i], data[j]);
+      }
+    }
+
+    NttVector roots(size / 2, data.get_allocator());
+    for (std::size_t len = 1; len < size; len <<= 1) {
+      uint32_t root = Pow(primitive_root, (modulo - 1) / (2 * len));
+      if (inverse) {
+        root = Inverse(root);
+      }
+      root = ToMont(root);
+
+      roots[0] = kOne;
+      for (std::size_t j = 1; j < len; ++j) {
+        roots[j] = MulMont(roots[j - 1], root);
+      }
+
+      for (std::size_t i = 0; i < size; i += 2 * len) {
+        for (std::size_t j = 0; j < len; ++j) {
+          uint32_t u = data[i + j];
+          uint32_t v = MulMont(data[i + j + len], roots[j]);
+          data[i + j] = u + v >= modulo ? u + v - modulo : u + v;
+          data[i + j + len] = u >= v ? u - v : u + modulo - v;
+        }
+      }
+    }
+  }
+};
+
+using NttField0 = NttField<998'244'353, 3>;
+using NttField1 = NttField<167'772'161, 3>;
+using NttField2 = NttField<469'762'049, 3>;
+
+// Every product is split into 32 bit coefficients. Three primes are enough
+// to restore coefficients of convolutions up to NttField0::kMaxSize long
+inline constexpr std::size_t kNttChunkBSize = 32;
+
+constexpr bool NttFits(std::size_t product_bits) noexcept {
+  std::size_t chunks = (product_bits + kNttChunkBSize - 1) / kNttChunkBSize;
+  return chunks <= NttField0::kMaxSize;
+}
+
+// Repacks words of W into 32 bit chunks, least significant first
+template<typename W>
+constexpr NttVector NttSplit(const RandomAccessRange<W> auto& range,
+                             std::size_t size,
+                             ResourceAllocator<uint32_t> allocator) noexcept {
+  constexpr std::size_t kWordBSize = std::numeric_limits<W>::digits;
+
+  NttVector ret(allocator);
+  ret.reserve(size);
+
+  uint64_t chunk = 0;
+  std::size_t filled = 0;
+  for (W word : range) {
+    for (std::size_t left = kWordBSize; left > 0;) {
+      std::size_t take = std::min(left, kNttChunkBSize - filled);
+      uint64_t mask = (uint64_t{1} << take) - 1;
+      chunk |= (static_cast<uint64_t>(word) & mask) << filled;
+      word = take < kWordBSize ? word >> take : 0;
+      left -= take;
+      filled += take;
+
+      if (filled == kNttChunkBSize) {
+        ret.push_back(static_cast<uint32_t>(chunk));
+        chunk = 0;
+        filled = 0;
+      }
+    }
+  }
+
+  if (filled != 0) {
+    ret.push_back(static_cast<uint32_t>(chunk));
+  }
+  ret.resize(size, 0);
+  return ret;
+}
+
+/*
+ * Restores coefficients of a convolution from its residues r0, r1, r2 and
+ * repacks them into words words of W
+ */
+template<typename W>
+constexpr std::vector<W, ResourceAllocator<W>>
+NttCombine(const NttVector& r0, const NttVector& r1, const NttVector& r2,
+           std::size_t words) noexcept {
+  constexpr std::size_t kWordBSize = std::numeric_limits<W>::digits;
+
+  // Garner's algorithm: coefficient = a0 + p0 * a1 + p0 * p1 * a2
+  constexpr uint64_t p0 = 998'244'353;
+  constexpr uint64_t p1 = 167'772'161;
+  constexpr uint64_t p2 = 469'762'049;
+  constexpr uint64_t p0_inv_1 = NttField1::Inverse(p0 % p1);
+  constexpr uint64_t p01_inv_2 = NttField2::Inverse(p0 * p1 % p2);
+
+  std::vector<W, ResourceAllocator<W>> ret(words, 0, r0.get_allocator());
+  std::size_t word_idx = 0;
+  std::size_t filled = 0; // bits filled in ret[word_idx]
+  auto push_chunk = [&](uint64_t chunk) {
+    for (std::size_t left = kNttChunkBSize; left > 0 && word_idx < words;) {
+      std::size_t take = std::min(left, kWordBSize - filled);
+      uint64_t mask = take < 64 ? (uint64_t{1} << take) - 1 : ~uint64_t{0};
+      ret[word_idx] |= static_cast<W>(static_cast<W>(chunk & mask) << filled);
+      chunk = take < 64 ? chunk >> take : 0;
+      left -= take;
+      filled += take;
+
+      if (filled == kWordBSize) {
+        ++word_idx;
+        filled = 0;
+      }
+    }
+  };
+
+  const std::size_t chunks =
+      (words * kWordBSize + kNttChunkBSize - 1) / kNttChunkBSize;
+
+  // carry = hi * 2^32 + lo
+  uint64_t lo = 0, hi = 0;
+  for (std::size_t i = 0; i < chunks; ++i) {
+    uint64_t a0 = r0[i];
+    uint64_t a1 = (r1[i] + p1 - a0 % p1) * p0_inv_1 % p1;
+    uint64_t a2 = (r2[i] + p2 - (a0 + p0 * a1) % p2) * p01_inv_2 % p2;
+    uint64_t t = a1 + p1 * a2; // coefficient = a0 + p0 * t
+
+    lo += a0 + p0 * (t & 0xffff'ffff);
+    hi += p0 * (t >> 32) + (lo >> 32);
+    lo &= 0xffff'ffff;
+
+    push_chunk(lo);
+    lo = hi & 0xffff'ffff;
+    hi >>= 32;
+  }
+  ASSERT(lo == 0 && hi == 0);
+
+  return ret;
+}
+
+template<typename W>
+constexpr std::size_t NttChunks(std::size_t words) noexcept {
+  return (words * std::numeric_limits<W>::digits + kNttChunkBSize - 1) /
+         kNttChunkBSize;
+}
+
+/*
+ * Product of two nonnegative numbers given as ranges of words
+ * (least significant first). Result has exactly lhs_size + rhs_size words
+ */
+template<typename W>
+constexpr std::vector<W, ResourceAllocator<W>>
+NttMultiply(const RandomAccessRange<W> auto& lhs,
+            const RandomAccessRange<W> auto& rhs,
+            ResourceAllocator<W> allocator = {}) {
+  const std::size_t words = std::ranges::size(lhs) + std::ranges::size(rhs);
+  ASSERT(NttFits(words * std::numeric_limits<W>::digits),
+         "Product is too long for NTT");
+
+  const std::size_t size = std::bit_ceil(NttChunks<W>(std::ranges::size(lhs)) +
+                                         NttChunks<W>(std::ranges::size(rhs)));
+
+  auto convolve = [&]<typename Field>(Field) {
+    NttVector lhs_part = NttSplit<W>(lhs, size, allocator);
+    NttVector rhs_part = NttSplit<W>(rhs, size, allocator);
+    Field::Convolve(lhs_part, rhs_part);
+    return lhs_part;
+  };
+
+  return NttCombine<W>(convolve(NttField0{}), convolve(NttField1{}),
+                       convolve(NttField2{}), words);
+}
+
+// Same as NttMultiply(range, range), but with one forward transform per prime
+template<typename W>
+constexpr std::vector<W, ResourceAllocator<W>>
+NttSquare(const RandomAccessRange<W> auto& range,
+          ResourceAllocator<W> allocator = {}) {
+  const std::size_t words = 2 * std::ranges::size(range);
+  ASSERT(NttFits(words * std::numeric_limits<W>::digits),
+         "Product is too long for NTT");
+
+  const std::size_t size =
+      std::bit_ceil(2 * NttChunks<W>(std::ranges::size(range)));
+
+  auto square = [&]<typename Field>(Field) {
+    NttVector part = NttSplit<W>(range, size, allocator);
+    Field::Square(part);
+    return part;
+  };
+
+  return NttCombine<W>(square(NttField0{}), square(NttField1{}),
+                       square(NttField2{}), words);
+}
+
+} // namespace algo::detail
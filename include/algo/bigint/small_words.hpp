@@ -0,0 +1,380 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+namespace algo::detail {
+
+/*
+ * Allocator of InfInt words and scratch buffers. Memory comes from the
+ * given std::pmr::memory_resource, e.g. a monotonic arena, or from
+ * std::allocator if none is given. Like std::pmr::polymorphic_allocator,
+ * it is not propagated by copy construction of containers, which get
+ * std::allocator instead. Unlike it, it is propagated by move assignment
+ */
+template<typename T>
+class ResourceAllocator {
+public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+
+  constexpr ResourceAllocator(
+      std::pmr::memory_resource* resource = nullptr) noexcept;
+  template<typename U>
+  constexpr ResourceAllocator(const ResourceAllocator<U>& other) noexcept;
+
+  constexpr ResourceAllocator
+  select_on_container_copy_construction() const noexcept;
+
+  constexpr T* allocate(std::size_t n);
+  constexpr void deallocate(T* ptr, std::size_t n) noexcept;
+
+  constexpr std::pmr::memory_resource* resource() const noexcept;
+
+  constexpr bool
+  operator==(const ResourceAllocator&) const noexcept = default;
+
+private:
+  std::pmr::memory_resource* resource_;
+};
+
+/*
+ * Word buffer of InfInt. Up to kInlineWords words are stored in place of
+ * the heap pointer, so small numbers are never allocated. Size is the whole
+ * capacity, words are zero initialized like the ones of std::vector.
+ * Allocator is propagated like the one of std::vector, moved from buffer
+ * is left inline.
+ *
+ * Heap words are shared by copies with the same allocator and freed with
+ * the last one, reference counter is atomic. Non-const access to words,
+ * i.e. data(), operator[], begin() and end(), copies shared words first,
+ * so writes through it never reach other copies. Readers of a non-const
+ * buffer should use std::as_const() to keep the words shared. Pointers
+ * taken before a copy of the buffer is made may point to shared words.
+ * Constant evaluation can't place the counter before words, so there
+ * words are allocated alone and copied instead of shared
+ */
+template<typename Word>
+class SmallWords {
+public:
+  using Allocator = ResourceAllocator<Word>;
+
+  static constexpr std::size_t kInlineWords = 2 * sizeof(Word*) / sizeof(Word);
+
+  constexpr SmallWords(Allocator allocator = {}) noexcept;
+  constexpr explicit SmallWords(std::size_t size,
+                                Allocator allocator = {}) noexcept;
+  constexpr SmallWords(const SmallWords&) noexcept;
+  constexpr SmallWords(const SmallWords& other, Allocator allocator) noexcept;
+  constexpr SmallWords(SmallWords&&) noexcept;
+  constexpr SmallWords& operator=(const SmallWords&) noexcept;
+  constexpr SmallWords& operator=(SmallWords&&) noexcept;
+  constexpr ~SmallWords();
+
+  constexpr Allocator get_allocator() const noexcept;
+  constexpr bool IsShared() const noexcept;
+
+  constexpr std::size_t size() const noexcept;
+  constexpr Word* data() noexcept;
+  constexpr const Word* data() const noexcept;
+
+  constexpr Word& operator[](std::size_t idx) noexcept;
+  constexpr const Word& operator[](std::size_t idx) const noexcept;
+
+  constexpr Word* begin() noexcept;
+  constexpr Word* end() noexcept;
+  constexpr const Word* begin() const noexcept;
+  constexpr const Word* end() const noexcept;
+  constexpr const Word* cbegin() const noexcept;
+  constexpr const Word* cend() const noexcept;
+
+private:
+  // Precedes heap words in the same allocation
+  struct Header {
+    std::atomic<std::size_t> references;
+  };
+
+  constexpr bool IsInline() const noexcept;
+  constexpr void ResetInline() noexcept;
+  constexpr void Unshare() noexcept;
+  Header* GetHeader() const noexcept;
+  constexpr void Deallocate() noexcept;
+
+  static constexpr std::size_t HeadersCount(std::size_t size) noexcept;
+
+  union {
+    Word* heap_;
+    Word inline_[kInlineWords];
+  };
+  std::size_t size_;
+  Allocator allocator_;
+};
+
+// Implementation
+template<typename T>
+constexpr ResourceAllocator<T>::ResourceAllocator(
+    std::pmr::memory_resource* resource) noexcept
+    : resource_{resource} {}
+
+template<typename T>
+template<typename U>
+constexpr ResourceAllocator<T>::ResourceAllocator(
+    const ResourceAllocator<U>& other) noexcept
+    : resource_{other.resource()} {}
+
+template<typename T>
+constexpr ResourceAllocator<T>
+ResourceAllocator<T>::select_on_container_copy_construction() const noexcept {
+  return {};
+}
+
+template<typename T>
+constexpr T* ResourceAllocator<T>::allocate(std::size_t n) {
+  if (resource_ == nullptr) {
+    return std::allocator<T>{}.allocate(n);
+  }
+  return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+}
+
+template<typename T>
+constexpr void ResourceAllocator<T>::deallocate(T* ptr,
+                                                std::size_t n) noexcept {
+  if (resource_ == nullptr) {
+    std::allocator<T>{}.deallocate(ptr, n);
+  } else {
+    resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+}
+
+template<typename T>
+constexpr std::pmr::memory_resource*
+ResourceAllocator<T>::resource() const noexcept {
+  return resource_;
+}
+
+template<typename Word>
+constexpr SmallWords<Word>::SmallWords(Allocator allocator) noexcept
+    : inline_{}
+    , size_{kInlineWords}
+    , allocator_{allocator} {}
+
+template<typename Word>
+constexpr SmallWords<Word>::SmallWords(std::size_t size,
+                                       Allocator allocator) noexcept
+    : SmallWords(allocator) {
+  if (size > kInlineWords) {
+    if (std::is_constant_evaluated()) {
+      heap_ = allocator_.allocate(size);
+    } else {
+      ResourceAllocator<Header> allocator{allocator_};
+      Header* header = allocator.allocate(HeadersCount(size));
+      std::construct_at(header, 1);
+      heap_ = reinterpret_cast<Word*>(header + 1);
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      std::construct_at(heap_ + i);
+    }
+    size_ = size;
+  }
+}
+
+template<typename Word>
+constexpr SmallWords<Word>::SmallWords(const SmallWords& other) noexcept
+    : SmallWords(other,
+                 other.allocator_.select_on_container_copy_construction()) {}
+
+template<typename Word>
+constexpr SmallWords<Word>::SmallWords(const SmallWords& other,
+                                       Allocator allocator) noexcept
+    : SmallWords(allocator) {
+  if (other.IsInline()) {
+    for (std::size_t i = 0; i < kInlineWords; ++i) {
+      inline_[i] = other.inline_[i];
+    }
+  } else if (std::is_constant_evaluated() || allocator_ != other.allocator_) {
+    SmallWords copy(other.size_, allocator_);
+    for (std::size_t i = 0; i < copy.size_; ++i) {
+      copy.heap_[i] = other.heap_[i];
+    }
+    *this = static_cast<SmallWords&&>(copy);
+  } else {
+    other.GetHeader()->references.fetch_add(1, std::memory_order_relaxed);
+    heap_ = other.heap_;
+    size_ = other.size_;
+  }
+}
+
+template<typename Word>
+constexpr SmallWords<Word>::SmallWords(SmallWords&& other) noexcept
+    : SmallWords(other.allocator_) {
+  *this = static_cast<SmallWords&&>(other);
+}
+
+template<typename Word>
+constexpr SmallWords<Word>&
+SmallWords<Word>::operator=(const SmallWords& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  // Allocator is kept, words of another one are copied
+  *this = SmallWords{other, allocator_};
+  return *this;
+}
+
+template<typename Word>
+constexpr SmallWords<Word>&
+SmallWords<Word>::operator=(SmallWords&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+
+  Deallocate();
+  allocator_ = other.allocator_;
+  if (other.IsInline()) {
+    for (std::size_t i = 0; i < kInlineWords; ++i) {
+      inline_[i] = other.inline_[i];
+    }
+    size_ = kInlineWords;
+  } else {
+    heap_ = other.heap_;
+    size_ = other.size_;
+    other.ResetInline();
+  }
+  return *this;
+}
+
+template<typename Word>
+constexpr SmallWords<Word>::~SmallWords() {
+  Deallocate();
+}
+
+template<typename Word>
+constexpr typename SmallWords<Word>::Allocator
+SmallWords<Word>::get_allocator() const noexcept {
+  return allocator_;
+}
+
+template<typename Word>
+constexpr bool SmallWords<Word>::IsShared() const noexcept {
+  return !IsInline() && !std::is_constant_evaluated() &&
+         GetHeader()->references.load(std::memory_order_acquire) != 1;
+}
+
+template<typename Word>
+constexpr std::size_t SmallWords<Word>::size() const noexcept {
+  return size_;
+}
+
+template<typename Word>
+constexpr Word* SmallWords<Word>::data() noexcept {
+  if (IsShared()) [[unlikely]] {
+    Unshare();
+  }
+  return IsInline() ? inline_ : heap_;
+}
+
+template<typename Word>
+constexpr const Word* SmallWords<Word>::data() const noexcept {
+  return IsInline() ? inline_ : heap_;
+}
+
+template<typename Word>
+constexpr Word& SmallWords<Word>::operator[](std::size_t idx) noexcept {
+  return data()[idx];
+}
+
+template<typename Word>
+constexpr const Word&
+SmallWords<Word>::operator[](std::size_t idx) const noexcept {
+  return data()[idx];
+}
+
+template<typename Word>
+constexpr Word* SmallWords<Word>::begin() noexcept {
+  return data();
+}
+
+template<typename Word>
+constexpr Word* SmallWords<Word>::end() noexcept {
+  return data() + size_;
+}
+
+template<typename Word>
+constexpr const Word* SmallWords<Word>::begin() const noexcept {
+  return data();
+}
+
+template<typename Word>
+constexpr const Word* SmallWords<Word>::end() const noexcept {
+  return data() + size_;
+}
+
+template<typename Word>
+constexpr const Word* SmallWords<Word>::cbegin() const noexcept {
+  return begin();
+}
+
+template<typename Word>
+constexpr const Word* SmallWords<Word>::cend() const noexcept {
+  return end();
+}
+
+template<typename Word>
+constexpr bool SmallWords<Word>::IsInline() const noexcept {
+  return size_ == kInlineWords;
+}
+
+template<typename Word>
+constexpr void SmallWords<Word>::ResetInline() noexcept {
+  // Assignment by subscript makes inline words the active member
+  for (std::size_t i = 0; i < kInlineWords; ++i) {
+    inline_[i] = 0;
+  }
+  size_ = kInlineWords;
+}
+
+template<typename Word>
+constexpr void SmallWords<Word>::Unshare() noexcept {
+  SmallWords copy(size_, allocator_);
+  for (std::size_t i = 0; i < size_; ++i) {
+    copy.heap_[i] = heap_[i];
+  }
+  *this = static_cast<SmallWords&&>(copy);
+}
+
+template<typename Word>
+typename SmallWords<Word>::Header*
+SmallWords<Word>::GetHeader() const noexcept {
+  return reinterpret_cast<Header*>(heap_) - 1;
+}
+
+template<typename Word>
+constexpr void SmallWords<Word>::Deallocate() noexcept {
+  if (IsInline()) {
+    return;
+  }
+  if (std::is_constant_evaluated()) {
+    allocator_.deallocate(heap_, size_);
+    return;
+  }
+
+  Header* header = GetHeader();
+  if (header->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::destroy_at(header);
+    ResourceAllocator<Header>{allocator_}.deallocate(header,
+                                                     HeadersCount(size_));
+  }
+}
+
+template<typename Word>
+constexpr std::size_t
+SmallWords<Word>::HeadersCount(std::size_t size) noexcept {
+  static_assert(alignof(Header) % alignof(Word) == 0);
+  return 1 + (size * sizeof(Word) + sizeof(Header) - 1) / sizeof(Header);
+}
+
+} // namespace algo::detail
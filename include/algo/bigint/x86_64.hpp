@@ -0,0 +1,459 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace algo::detail {
+
+enum class BitOp { kAnd, kOr, kXor, kNot };
+
+/*
+ * Carry chain loops on x86-64 for BigIntKernel. AddN and SubN are built on
+ * ADC and SBB, which every x86-64 processor has. Mul1, AddMul1 and SubMul1
+ * are available for 64 bit words on processors with BMI2 and ADX only, where
+ * MULX doesn't touch flags and ADCX and ADOX keep two independent carry
+ * chains. Loops are unrolled by four words, r may be the same as a or b.
+ *
+ * Bitwise loops and scans for equal or zero words use AVX-512 or AVX2.
+ * They process whole vectors only and return how far they got, the rest
+ * is left to scalar code
+ */
+template<typename Word>
+struct X86Kernels {
+  static constexpr bool kAddSub = false;
+  static constexpr bool kMul = false;
+  static constexpr bool kSimd = false;
+};
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+
+namespace x86_64 {
+
+inline unsigned char AddCarry(unsigned char carry, uint32_t lhs, uint32_t rhs,
+                              uint32_t& ret) noexcept {
+  unsigned int sum;
+  carry = _addcarry_u32(carry, lhs, rhs, &sum);
+  ret = sum;
+  return carry;
+}
+
+inline unsigned char AddCarry(unsigned char carry, uint64_t lhs, uint64_t rhs,
+                              uint64_t& ret) noexcept {
+  unsigned long long sum;
+  carry = _addcarry_u64(carry, lhs, rhs, &sum);
+  ret = sum;
+  return carry;
+}
+
+inline unsigned char SubBorrow(unsigned char borrow, uint32_t lhs,
+                               uint32_t rhs, uint32_t& ret) noexcept {
+  unsigned int diff;
+  borrow = _subborrow_u32(borrow, lhs, rhs, &diff);
+  ret = diff;
+  return borrow;
+}
+
+inline unsigned char SubBorrow(unsigned char borrow, uint64_t lhs,
+                               uint64_t rhs, uint64_t& ret) noexcept {
+  unsigned long long diff;
+  borrow = _subborrow_u64(borrow, lhs, rhs, &diff);
+  ret = diff;
+  return borrow;
+}
+
+// CPUID leaf 7 reports BMI2 in bit 8 and ADX in bit 19 of EBX
+inline bool DetectMulx() noexcept {
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+  return (ebx & (1u << 8)) != 0 && (ebx & (1u << 19)) != 0;
+}
+
+enum class Simd { kNone, kAvx2, kAvx512 };
+
+inline Simd DetectSimd() noexcept {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return Simd::kAvx512;
+  } else if (__builtin_cpu_supports("avx2")) {
+    return Simd::kAvx2;
+  }
+  return Simd::kNone;
+}
+
+// Detected once, when the first vector loop is called
+inline Simd SimdLevel() noexcept {
+  static const Simd kLevel = DetectSimd();
+  return kLevel;
+}
+
+// r op= a for whole vectors of size bytes, returns bytes processed
+template<BitOp op>
+__attribute__((target("avx2"))) inline std::size_t
+BitwiseAvx2(unsigned char* r, const unsigned char* a,
+            std::size_t size) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + i));
+    if constexpr (op == BitOp::kNot) {
+      x = _mm256_xor_si256(x, _mm256_set1_epi32(-1));
+    } else {
+      __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+      if constexpr (op == BitOp::kAnd) {
+        x = _mm256_and_si256(x, y);
+      } else if constexpr (op == BitOp::kOr) {
+        x = _mm256_or_si256(x, y);
+      } else {
+        x = _mm256_xor_si256(x, y);
+      }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), x);
+  }
+  return i;
+}
+
+template<BitOp op>
+__attribute__((target("avx512f"))) inline std::size_t
+BitwiseAvx512(unsigned char* r, const unsigned char* a,
+              std::size_t size) noexcept {
+  std::size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    __m512i x = _mm512_loadu_si512(r + i);
+    if constexpr (op == BitOp::kNot) {
+      x = _mm512_xor_si512(x, _mm512_set1_epi32(-1));
+    } else {
+      __m512i y = _mm512_loadu_si512(a + i);
+      if constexpr (op == BitOp::kAnd) {
+        x = _mm512_and_si512(x, y);
+      } else if constexpr (op == BitOp::kOr) {
+        x = _mm512_or_si512(x, y);
+      } else {
+        x = _mm512_xor_si512(x, y);
+      }
+    }
+    _mm512_storeu_si512(r + i, x);
+  }
+  return i;
+}
+
+// Bytes [n, size) of a and b (of a and zero, if b is null) are equal for
+// the returned n. Either n is 0 or less than a vector, or byte n - 1 lies
+// in the highest differing 8 bytes
+__attribute__((target("avx2"))) inline std::size_t
+EqualTopAvx2(const unsigned char* a, const unsigned char* b,
+             std::size_t size) noexcept {
+  std::size_t n = size;
+  for (; n >= 32; n -= 32) {
+    __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + n - 32));
+    __m256i y = _mm256_setzero_si256();
+    if (b != nullptr) {
+      y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + n - 32));
+    }
+    auto equal = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi64(x, y)));
+    if (equal != ~uint32_t{0}) {
+      return n - std::countl_zero(~equal);
+    }
+  }
+  return n;
+}
+
+__attribute__((target("avx512f"))) inline std::size_t
+EqualTopAvx512(const unsigned char* a, const unsigned char* b,
+               std::size_t size) noexcept {
+  std::size_t n = size;
+  for (; n >= 64; n -= 64) {
+    __m512i x = _mm512_loadu_si512(a + n - 64);
+    __m512i y = _mm512_setzero_si512();
+    if (b != nullptr) {
+      y = _mm512_loadu_si512(b + n - 64);
+    }
+    if (auto differ = static_cast<uint8_t>(_mm512_cmpneq_epi64_mask(x, y));
+        differ != 0) {
+      return n - 8 * std::countl_zero(differ);
+    }
+  }
+  return n;
+}
+
+// Words of a tail, which doesn't fill the last block of four
+inline uint64_t AddMul1Tail(uint64_t* r, const uint64_t* a, std::size_t n,
+                            uint64_t b, uint64_t carry, bool add) noexcept {
+  __extension__ using DoubleWord = unsigned __int128;
+  for (std::size_t i = 0; i < n; ++i) {
+    DoubleWord prod = static_cast<DoubleWord>(a[i]) * b + carry;
+    if (add) {
+      prod += r[i];
+    }
+    r[i] = static_cast<uint64_t>(prod);
+    carry = static_cast<uint64_t>(prod >> 64);
+  }
+  return carry;
+}
+
+inline uint64_t SubMul1Tail(uint64_t* r, const uint64_t* a, std::size_t n,
+                            uint64_t b, uint64_t carry) noexcept {
+  __extension__ using DoubleWord = unsigned __int128;
+  for (std::size_t i = 0; i < n; ++i) {
+    DoubleWord prod = static_cast<DoubleWord>(a[i]) * b + carry;
+    uint64_t sub = static_cast<uint64_t>(prod);
+    uint64_t lhs = r[i];
+    r[i] = lhs - sub;
+    carry = static_cast<uint64_t>(prod >> 64) + (lhs < sub);
+  }
+  return carry;
+}
+
+} // namespace x86_64
+
+template<typename Word>
+struct X86AddSub {
+  static constexpr bool kAddSub = true;
+
+  static bool AddN(Word* r, const Word* a, const Word* b,
+                   std::size_t n) noexcept {
+    unsigned char carry = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      carry = x86_64::AddCarry(carry, a[i], b[i], r[i]);
+      carry = x86_64::AddCarry(carry, a[i + 1], b[i + 1], r[i + 1]);
+      carry = x86_64::AddCarry(carry, a[i + 2], b[i + 2], r[i + 2]);
+      carry = x86_64::AddCarry(carry, a[i + 3], b[i + 3], r[i + 3]);
+    }
+    for (; i < n; ++i) {
+      carry = x86_64::AddCarry(carry, a[i], b[i], r[i]);
+    }
+    return carry != 0;
+  }
+
+  static bool SubN(Word* r, const Word* a, const Word* b,
+                   std::size_t n) noexcept {
+    unsigned char borrow = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      borrow = x86_64::SubBorrow(borrow, a[i], b[i], r[i]);
+      borrow = x86_64::SubBorrow(borrow, a[i + 1], b[i + 1], r[i + 1]);
+      borrow = x86_64::SubBorrow(borrow, a[i + 2], b[i + 2], r[i + 2]);
+      borrow = x86_64::SubBorrow(borrow, a[i + 3], b[i + 3], r[i + 3]);
+    }
+    for (; i < n; ++i) {
+      borrow = x86_64::SubBorrow(borrow, a[i], b[i], r[i]);
+    }
+    return borrow != 0;
+  }
+};
+
+template<typename Word>
+struct X86Simd {
+  static constexpr bool kSimd = true;
+
+  // Vectors are not worth a call for a few words
+  static constexpr std::size_t kMinBytes = 128;
+
+  // r op= a (r = ~r), returns words processed from the lowest
+  template<BitOp op>
+  static std::size_t Bitwise(Word* r, const Word* a, std::size_t n) noexcept {
+    const std::size_t size = n * sizeof(Word);
+    if (size < kMinBytes) {
+      return 0;
+    }
+
+    auto* r_bytes = reinterpret_cast<unsigned char*>(r);
+    auto* a_bytes = reinterpret_cast<const unsigned char*>(a);
+    switch (x86_64::SimdLevel()) {
+    case x86_64::Simd::kAvx512:
+      return x86_64::BitwiseAvx512<op>(r_bytes, a_bytes, size) / sizeof(Word);
+    case x86_64::Simd::kAvx2:
+      return x86_64::BitwiseAvx2<op>(r_bytes, a_bytes, size) / sizeof(Word);
+    default:
+      return 0;
+    }
+  }
+
+  // Words [ret, n) of a and b (of a and zero, if b is null) are equal, the
+  // most significant differing word, if any, is one of the next two below
+  static std::size_t EqualTop(const Word* a, const Word* b,
+                              std::size_t n) noexcept {
+    const std::size_t size = n * sizeof(Word);
+    if (size < kMinBytes) {
+      return n;
+    }
+
+    auto* a_bytes = reinterpret_cast<const unsigned char*>(a);
+    auto* b_bytes = reinterpret_cast<const unsigned char*>(b);
+    std::size_t equal_from = size;
+    switch (x86_64::SimdLevel()) {
+    case x86_64::Simd::kAvx512:
+      equal_from = x86_64::EqualTopAvx512(a_bytes, b_bytes, size);
+      break;
+    case x86_64::Simd::kAvx2:
+      equal_from = x86_64::EqualTopAvx2(a_bytes, b_bytes, size);
+      break;
+    default:
+      break;
+    }
+    return (equal_from + sizeof(Word) - 1) / sizeof(Word);
+  }
+};
+
+template<>
+struct X86Kernels<uint32_t> : X86AddSub<uint32_t>, X86Simd<uint32_t> {
+  static constexpr bool kMul = false;
+};
+
+template<>
+struct X86Kernels<uint64_t> : X86AddSub<uint64_t>, X86Simd<uint64_t> {
+  static constexpr bool kMul = true;
+
+  // Detected once, when the first multiplication happens
+  static bool HasMulx() noexcept {
+    static const bool kHasMulx = x86_64::DetectMulx();
+    return kHasMulx;
+  }
+
+  // r = a * b, returns high word. Low words of products are added to high
+  // words of previous ones by a single ADCX chain
+  __attribute__((target("bmi2,adx"))) static uint64_t
+  Mul1(uint64_t* r, const uint64_t* a, std::size_t n, uint64_t b) noexcept {
+    uint64_t carry = 0;
+    if (std::size_t blocks = n / 4; blocks != 0) {
+      uint64_t lo, hi;
+      __asm__("xor %%r10d, %%r10d\n\t"
+              "1:\n\t"
+              "mulx (%[a]), %[lo], %[hi]\n\t"
+              "adcx %[carry], %[lo]\n\t"
+              "mov %[lo], (%[r])\n\t"
+              "mulx 8(%[a]), %[lo], %[carry]\n\t"
+              "adcx %[hi], %[lo]\n\t"
+              "mov %[lo], 8(%[r])\n\t"
+              "mulx 16(%[a]), %[lo], %[hi]\n\t"
+              "adcx %[carry], %[lo]\n\t"
+              "mov %[lo], 16(%[r])\n\t"
+              "mulx 24(%[a]), %[lo], %[carry]\n\t"
+              "adcx %[hi], %[lo]\n\t"
+              "mov %[lo], 24(%[r])\n\t"
+              // LEA and JRCXZ keep CF intact
+              "lea 32(%[a]), %[a]\n\t"
+              "lea 32(%[r]), %[r]\n\t"
+              "lea -1(%[blocks]), %[blocks]\n\t"
+              "jrcxz 2f\n\t"
+              "jmp 1b\n\t"
+              "2:\n\t"
+              "adcx %%r10, %[carry]\n\t"
+              : [a] "+r"(a), [r] "+r"(r), [blocks] "+c"(blocks),
+                [carry] "+r"(carry), [lo] "=&r"(lo), [hi] "=&r"(hi)
+              : "d"(b)
+              : "r10", "cc", "memory");
+    }
+    return x86_64::AddMul1Tail(r, a, n % 4, b, carry, false);
+  }
+
+  // r += a * b, returns carry word. High word of the previous product is
+  // added by ADOX chain, the result is added to r by ADCX chain
+  __attribute__((target("bmi2,adx"))) static uint64_t
+  AddMul1(uint64_t* r, const uint64_t* a, std::size_t n, uint64_t b) noexcept {
+    uint64_t carry = 0;
+    if (std::size_t blocks = n / 4; blocks != 0) {
+      uint64_t lo, hi;
+      __asm__("xor %%r10d, %%r10d\n\t"
+              "1:\n\t"
+              "mulx (%[a]), %[lo], %[hi]\n\t"
+              "adox %[carry], %[lo]\n\t"
+              "adcx (%[r]), %[lo]\n\t"
+              "mov %[lo], (%[r])\n\t"
+              "mulx 8(%[a]), %[lo], %[carry]\n\t"
+              "adox %[hi], %[lo]\n\t"
+              "adcx 8(%[r]), %[lo]\n\t"
+              "mov %[lo], 8(%[r])\n\t"
+              "mulx 16(%[a]), %[lo], %[hi]\n\t"
+              "adox %[carry], %[lo]\n\t"
+              "adcx 16(%[r]), %[lo]\n\t"
+              "mov %[lo], 16(%[r])\n\t"
+              "mulx 24(%[a]), %[lo], %[carry]\n\t"
+              "adox %[hi], %[lo]\n\t"
+              "adcx 24(%[r]), %[lo]\n\t"
+              "mov %[lo], 24(%[r])\n\t"
+              // LEA and JRCXZ keep both CF and OF intact
+              "lea 32(%[a]), %[a]\n\t"
+              "lea 32(%[r]), %[r]\n\t"
+              "lea -1(%[blocks]), %[blocks]\n\t"
+              "jrcxz 2f\n\t"
+              "jmp 1b\n\t"
+              "2:\n\t"
+              // Carry word is at most B - 2, both carries fit into it
+              "adox %%r10, %[carry]\n\t"
+              "adcx %%r10, %[carry]\n\t"
+              : [a] "+r"(a), [r] "+r"(r), [blocks] "+c"(blocks),
+                [carry] "+r"(carry), [lo] "=&r"(lo), [hi] "=&r"(hi)
+              : "d"(b)
+              : "r10", "cc", "memory");
+    }
+    return x86_64::AddMul1Tail(r, a, n % 4, b, carry, true);
+  }
+
+  // r -= a * b, returns borrow word. Same as AddMul1 for r - p = ~(~r + p),
+  // NOT doesn't touch flags
+  __attribute__((target("bmi2,adx"))) static uint64_t
+  SubMul1(uint64_t* r, const uint64_t* a, std::size_t n, uint64_t b) noexcept {
+    uint64_t carry = 0;
+    if (std::size_t blocks = n / 4; blocks != 0) {
+      uint64_t lo, hi, word;
+      __asm__("xor %%r10d, %%r10d\n\t"
+              "1:\n\t"
+              "mulx (%[a]), %[lo], %[hi]\n\t"
+              "adox %[carry], %[lo]\n\t"
+              "mov (%[r]), %[word]\n\t"
+              "not %[word]\n\t"
+              "adcx %[lo], %[word]\n\t"
+              "not %[word]\n\t"
+              "mov %[word], (%[r])\n\t"
+              "mulx 8(%[a]), %[lo], %[carry]\n\t"
+              "adox %[hi], %[lo]\n\t"
+              "mov 8(%[r]), %[word]\n\t"
+              "not %[word]\n\t"
+              "adcx %[lo], %[word]\n\t"
+              "not %[word]\n\t"
+              "mov %[word], 8(%[r])\n\t"
+              "mulx 16(%[a]), %[lo], %[hi]\n\t"
+              "adox %[carry], %[lo]\n\t"
+              "mov 16(%[r]), %[word]\n\t"
+              "not %[word]\n\t"
+              "adcx %[lo], %[word]\n\t"
+              "not %[word]\n\t"
+              "mov %[word], 16(%[r])\n\t"
+              "mulx 24(%[a]), %[lo], %[carry]\n\t"
+              "adox %[hi], %[lo]\n\t"
+              "mov 24(%[r]), %[word]\n\t"
+              "not %[word]\n\t"
+              "adcx %[lo], %[word]\n\t"
+              "not %[word]\n\t"
+              "mov %[word], 24(%[r])\n\t"
+              "lea 32(%[a]), %[a]\n\t"
+              "lea 32(%[r]), %[r]\n\t"
+              "lea -1(%[blocks]), %[blocks]\n\t"
+              "jrcxz 2f\n\t"
+              "jmp 1b\n\t"
+              "2:\n\t"
+              "adox %%r10, %[carry]\n\t"
+              "adcx %%r10, %[carry]\n\t"
+              : [a] "+r"(a), [r] "+r"(r), [blocks] "+c"(blocks),
+                [carry] "+r"(carry), [lo] "=&r"(lo), [hi] "=&r"(hi),
+                [word] "=&r"(word)
+              : "d"(b)
+              : "r10", "cc", "memory");
+    }
+    return x86_64::SubMul1Tail(r, a, n % 4, b, carry);
+  }
+};
+
+#endif
+
+} // namespace algo::detail
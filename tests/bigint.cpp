@@ -1,10 +1,95 @@
 #include "utils.hpp"
 #include <algo/bigint.hpp>
+#include <algo/bigint/divisor.hpp>
+#include <algo/bigint/lazy.hpp>
+#include <algo/sync/thread_pool.hpp>
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <bitset>
+#include <cstdlib>
 #include <fstream>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <optional>
+
+namespace algo {
+
+struct BigIntPeer {
+  template<typename Int>
+  static Int NttMul(Int lhs, const Int& rhs) {
+    lhs.NttUMulByRange(rhs.ToView());
+    return lhs;
+  }
+
+  template<std::size_t lhs_parts, std::size_t rhs_parts, std::size_t cap,
+           typename W, typename DW>
+  static BigInt<cap, W, DW> ToomMul(BigInt<cap, W, DW> lhs,
+                                    const BigInt<cap, W, DW>& rhs) {
+    lhs.template ToomUMulByRange<lhs_parts, rhs_parts>(rhs.ToView());
+    return lhs;
+  }
+
+  template<std::size_t cap, typename W, typename DW>
+  static BigInt<cap, W, DW> UnbalancedMul(BigInt<cap, W, DW> lhs,
+                                          const BigInt<cap, W, DW>& rhs) {
+    lhs.UnbalancedUMulByRange(rhs.ToView());
+    return lhs;
+  }
+
+  template<typename Int>
+  static Int BasecaseSquare(Int value) {
+    value.BasecaseUSquare();
+    return value;
+  }
+
+  template<typename Int>
+  static Int KaratsubaMul(Int lhs, const Int& rhs) {
+    lhs.KaratsubaUMulByRange(rhs.ToView());
+    return lhs;
+  }
+
+  template<typename Int>
+  static Int KaratsubaSquare(Int value) {
+    value.KaratsubaUSquare();
+    return value;
+  }
+
+  template<std::size_t parts, std::size_t cap, typename W, typename DW>
+  static BigInt<cap, W, DW> ToomSquare(BigInt<cap, W, DW> value) {
+    value.template ToomUSquare<parts>();
+    return value;
+  }
+
+  template<typename Int>
+  static Int NttSquare(Int value) {
+    value.NttUSquare();
+    return value;
+  }
+};
+
+} // namespace algo
+
+// Allocations by global operator new, which arena operations don't make
+std::atomic<std::size_t> global_allocations = 0;
+
+void* operator new(std::size_t size) {
+  global_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
 
 template<typename T>
 struct Converter {};
@@ -41,6 +126,66 @@ struct BigInt : algo::testing::Randomizer {
     return "0b1" + RandomString(size - 1, "01");
   }
 
+  // Number of 1 .. max_words 32 bit words with random sign
+  template<typename Int>
+  Int RandomSigned(std::size_t max_words) {
+    const std::size_t words = RandomInt<std::size_t>(1, max_words);
+    const std::string sign = RandomInt(0, 1) == 0 ? "" : "-";
+    return Int{sign + "0x" + RandomString(8 * words, "0123456789ABCDEF")};
+  }
+
+  // Calls check.template operator()<Int>(random) for numbers, which products
+  // are short and accumulated in place, or long and computed aside, random()
+  // gives such numbers
+  void ForProductSizes(auto&& check) {
+    auto run = [&]<typename Int>(std::size_t max_words) {
+      check.template operator()<Int>(
+          [this, max_words] { return RandomSigned<Int>(max_words); });
+    };
+    run.template operator()<algo::BigInt<256>>(40);
+    run.template operator()<algo::BigInt<16, uint64_t, algo::Uint128>>(4);
+    run.template operator()<algo::InfInt>(3);
+    run.template operator()<algo::InfInt>(60);
+  }
+
+  // Operations on random Int operands of lhs_words and rhs_words words are
+  // compared with the same ones on Reference, which fits every result
+  template<typename Int, typename Reference>
+  void CompareWithReference(
+      std::initializer_list<std::pair<std::size_t, std::size_t>> sizes) {
+    using Word = std::remove_cvref_t<decltype(Int{}.binary[0])>;
+    auto random_pair = [this](std::size_t words) {
+      std::string hex = "0x1" + RandomString(2 * sizeof(Word) * words - 1,
+                                             "0123456789ABCDEF");
+      return std::pair{Int{hex}, Reference{hex}};
+    };
+    auto check = [](const Int& lhs, const Reference& rhs) {
+      ASSERT_EQ(lhs.ToString(16), rhs.ToString(16));
+    };
+
+    for (auto [lhs_words, rhs_words] : sizes) {
+      auto [lhs, lhs_ref] = random_pair(lhs_words);
+      auto [rhs, rhs_ref] = random_pair(rhs_words);
+
+      Int product = lhs * rhs;
+      Reference product_ref = lhs_ref * rhs_ref;
+      check(product, product_ref);
+      check(rhs * rhs, rhs_ref * rhs_ref);
+      check(rhs - lhs, rhs_ref - lhs_ref);
+      check(lhs << 1'000, lhs_ref << 1'000);
+
+      Int divident = product + lhs;
+      Reference divident_ref = product_ref + lhs_ref;
+      check(divident / rhs, divident_ref / rhs_ref);
+      check(divident % rhs, divident_ref % rhs_ref);
+      check(algo::BigIntDivisor{rhs}.Mod(divident), divident_ref % rhs_ref);
+      check(product.DivExact(rhs), lhs_ref);
+
+      ASSERT_EQ(lhs.ToString(), lhs_ref.ToString());
+      ASSERT_EQ(Int{lhs.ToString()}, lhs);
+    }
+  }
+
   static std::string NaiveAdd(std::string_view lhs, std::string_view rhs) {
     if (lhs.starts_with("0b")) {
       lhs.remove_prefix(2);
@@ -267,6 +412,173 @@ TEST_F(BigInt, MulKaratsuba) {
       ASSERT_EQ(lhs * rhs, Int{mul_str}) << lhs << '\n' << rhs;
     }
   }
+
+  {
+    // Deep recursion on balanced and skewed operands, compared with NTT
+    using LongInt = algo::BigInt<2100>;
+
+    SetSeed(2);
+    for (auto [lhs_wc, rhs_wc] : std::initializer_list<
+             std::pair<std::size_t, std::size_t>>{
+             {1000, 1000}, {999, 1001}, {1000, 400}, {1000, 40}, {33, 1000}}) {
+      std::vector<uint32_t> lhs_words(lhs_wc), rhs_words(rhs_wc);
+      for (uint32_t& w : lhs_words) {
+        w = RandomInt<uint32_t>();
+      }
+      for (uint32_t& w : rhs_words) {
+        w = RandomInt<uint32_t>();
+      }
+      rhs_words.back() = ~uint32_t{0};
+
+      LongInt lhs{lhs_words};
+      LongInt rhs{rhs_words};
+      ASSERT_EQ(algo::BigIntPeer::KaratsubaMul(lhs, rhs),
+                algo::BigIntPeer::NttMul(lhs, rhs))
+          << lhs_wc << ' ' << rhs_wc;
+      ASSERT_EQ(algo::BigIntPeer::KaratsubaSquare(lhs),
+                algo::BigIntPeer::NttMul(lhs, lhs))
+          << lhs_wc;
+    }
+  }
+}
+
+TEST_F(BigInt, MulToomCook) {
+  constexpr std::size_t cap = 100;
+  using Int = algo::BigInt<cap, uint8_t, uint16_t>;
+
+  SetSeed(1);
+  for (std::size_t i = 0; i < 100; ++i) {
+    std::string lhs_str = RandomBinary(RandomInt<std::size_t>(1, cap * 4));
+    std::string rhs_str =
+        RandomBinary(RandomInt<std::size_t>(1, cap * 8 - lhs_str.size()));
+
+    Int lhs{lhs_str};
+    Int rhs{rhs_str};
+    Int mul{NaiveMul(lhs_str, rhs_str)};
+    ASSERT_EQ((algo::BigIntPeer::ToomMul<3, 3>(lhs, rhs)), mul)
+        << lhs << '\n'
+        << rhs;
+    ASSERT_EQ((algo::BigIntPeer::ToomMul<4, 4>(lhs, rhs)), mul)
+        << lhs << '\n'
+        << rhs;
+  }
+}
+
+TEST_F(BigInt, MulUnbalanced) {
+  constexpr std::size_t cap = 100;
+  using Int = algo::BigInt<cap, uint8_t, uint16_t>;
+
+  SetSeed(1);
+  for (std::size_t i = 0; i < 100; ++i) {
+    std::string lhs_str = RandomBinary(RandomInt<std::size_t>(cap, cap * 7));
+    std::string rhs_str = RandomBinary(RandomInt<std::size_t>(
+        1, std::min(lhs_str.size() / 2, cap * 8 - lhs_str.size())));
+
+    Int lhs{lhs_str};
+    Int rhs{rhs_str};
+    Int mul{NaiveMul(lhs_str, rhs_str)};
+    ASSERT_EQ((algo::BigIntPeer::ToomMul<3, 2>(lhs, rhs)), mul)
+        << lhs << '\n'
+        << rhs;
+    ASSERT_EQ((algo::BigIntPeer::ToomMul<2, 4>(rhs, lhs)), mul)
+        << lhs << '\n'
+        << rhs;
+    ASSERT_EQ(algo::BigIntPeer::UnbalancedMul(lhs, rhs), mul)
+        << lhs << '\n'
+        << rhs;
+    ASSERT_EQ(algo::BigIntPeer::UnbalancedMul(rhs, lhs), mul)
+        << lhs << '\n'
+        << rhs;
+    ASSERT_EQ(lhs * rhs, mul) << lhs << '\n' << rhs;
+  }
+}
+
+TEST_F(BigInt, Square) {
+  {
+    constexpr std::size_t cap = 100;
+    using Int = algo::BigInt<cap, uint8_t, uint16_t>;
+
+    SetSeed(1);
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::string str = RandomBinary(RandomInt<std::size_t>(1, cap * 4));
+      Int value{str};
+      Int square{NaiveMul(str, str)};
+
+      ASSERT_EQ(algo::BigIntPeer::BasecaseSquare(value), square) << value;
+      ASSERT_EQ(algo::BigIntPeer::KaratsubaSquare(value), square) << value;
+      ASSERT_EQ(algo::BigIntPeer::ToomSquare<3>(value), square) << value;
+      ASSERT_EQ(algo::BigIntPeer::ToomSquare<4>(value), square) << value;
+      ASSERT_EQ(algo::BigIntPeer::NttSquare(value), square) << value;
+      ASSERT_EQ(Int{value}.Square(), square) << value;
+    }
+  }
+
+  {
+    using Int = algo::BigInt<2100>;
+
+    SetSeed(2);
+    for (std::size_t words : {1, 2, 30, 150, 300, 1000}) {
+      std::vector<uint32_t> value_words(words);
+      for (uint32_t& w : value_words) {
+        w = RandomInt<uint32_t>();
+      }
+
+      Int value{value_words, false};
+      Int square = value * Int{value};
+      ASSERT_TRUE(square.is_positive);
+
+      value *= value;
+      ASSERT_EQ(value, square);
+    }
+  }
+}
+
+TEST_F(BigInt, MulNtt) {
+  {
+    constexpr std::size_t cap = 100;
+    using Int = algo::BigInt<cap, uint8_t, uint16_t>;
+
+    SetSeed(1);
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::string lhs_str = RandomBinary(RandomInt<std::size_t>(1, cap * 4));
+      std::string rhs_str =
+          RandomBinary(RandomInt<std::size_t>(1, cap * 8 - lhs_str.size()));
+
+      Int lhs{lhs_str};
+      Int rhs{rhs_str};
+      Int mul{NaiveMul(lhs_str, rhs_str)};
+      ASSERT_EQ(algo::BigIntPeer::NttMul(lhs, rhs), mul) << lhs << '\n' << rhs;
+    }
+  }
+
+  {
+    // Operands are above threshold, compare with sum of smaller products
+    using Int = algo::BigInt<2100>;
+    constexpr std::size_t part = 64;
+
+    SetSeed(2);
+    for (std::size_t i = 0; i < 5; ++i) {
+      std::vector<uint32_t> lhs_words(RandomInt<std::size_t>(300, 1000));
+      std::vector<uint32_t> rhs_words(RandomInt<std::size_t>(300, 1000));
+      for (uint32_t& w : lhs_words) {
+        w = RandomInt<uint32_t>();
+      }
+      for (uint32_t& w : rhs_words) {
+        w = RandomInt<uint32_t>();
+      }
+
+      Int lhs{lhs_words};
+      Int expected;
+      for (std::size_t j = 0; j < rhs_words.size(); j += part) {
+        Int rhs_part{std::ranges::subrange(
+            rhs_words.begin() + j,
+            rhs_words.begin() + std::min(j + part, rhs_words.size()))};
+        expected += (lhs * rhs_part) << (j * 32);
+      }
+
+      ASSERT_EQ(lhs * Int{rhs_words}, expected);
+    }
+  }
 }
 
 TEST_F(BigInt, Serialize) {
@@ -285,6 +597,112 @@ TEST_F(BigInt, Serialize) {
   }
 }
 
+TEST_F(BigInt, SerializeLong) {
+  // Long numbers are split by powers of base
+  using Int = algo::BigInt<2000>;
+  SetSeed(7);
+
+  for (std::size_t i = 0; i < 3; ++i) {
+    std::string str =
+        RandomString(1, "123456789") +
+        RandomString(RandomInt<std::size_t>(5'000, 15'000), "0123456789");
+    ASSERT_EQ(Int{str}.ToString(), str);
+    ASSERT_EQ((-Int{str}).ToString(), "-" + str);
+  }
+
+  // Zero chunks in the middle should be padded
+  for (std::size_t zeros : {2'000, 9'000, 15'000}) {
+    std::string str = "1" + std::string(zeros, '0') + "1";
+    ASSERT_EQ(Int{str}.ToString(), str);
+    std::string nines(zeros, '9');
+    ASSERT_EQ(Int{nines}.ToString(), nines);
+  }
+
+  std::string binary = RandomBinary(30'000);
+  ASSERT_EQ(Int{binary}.ToString(2), binary.substr(2));
+
+  // Long numbers are parsed by halves
+  Int power{1};
+  for (std::size_t i = 0; i < 12'000; ++i) {
+    power *= Int{10};
+  }
+  ASSERT_EQ(Int{"1" + std::string(12'000, '0')}, power);
+  ASSERT_EQ(Int{"1'000'" + std::string(11'997, '0')}, power);
+}
+
+TEST_F(BigInt, SerializePowerOf2) {
+  // Digits in base 2^k are groups of k bits
+  auto regroup = [](std::string_view binary, std::size_t bits) {
+    constexpr std::string_view alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+    std::string ret;
+    for (std::size_t end = binary.size(); end > 0;) {
+      const std::size_t begin = end > bits ? end - bits : 0;
+      std::size_t digit = 0;
+      for (std::size_t i = begin; i < end; ++i) {
+        digit = digit * 2 + (binary[i] - '0');
+      }
+      ret.push_back(alphabet[digit]);
+      end = begin;
+    }
+    while (ret.size() > 1 && ret.back() == '0') {
+      ret.pop_back();
+    }
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+  };
+
+  auto check = [&]<typename Int>(std::size_t min_size, std::size_t max_size) {
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::string binary =
+          RandomBinary(RandomInt<std::size_t>(min_size, max_size)).substr(2);
+      const Int value{"0b" + binary};
+      for (std::size_t bits = 1; bits <= 5; ++bits) {
+        ASSERT_EQ(value.ToString(1 << bits), regroup(binary, bits));
+      }
+
+      std::string hex = regroup(binary, 4);
+      ASSERT_EQ(Int{"0x" + hex}, value);
+      std::ranges::transform(hex, hex.begin(), [](char c) {
+        return c >= 'A' ? static_cast<char>(c - 'A' + 'a') : c;
+      });
+      ASSERT_EQ(Int{"-0x" + hex}, -value);
+      ASSERT_EQ(Int{"0o" + regroup(binary, 3)}, value);
+    }
+  };
+
+  SetSeed(11);
+  check.operator()<algo::BigInt<8, uint8_t, uint16_t>>(1, 64);
+  check.operator()<algo::BigInt<30, uint16_t, uint32_t>>(1, 480);
+  check.operator()<algo::BigInt<2000>>(10'000, 64'000);
+}
+
+TEST_F(BigInt, FromString) {
+  using Int = algo::BigInt<8, uint8_t, uint16_t>;
+  auto error = [](std::string_view str) {
+    return Int::FromString(str).ErrorOr({}).value();
+  };
+  const int kInvalid = static_cast<int>(std::errc::invalid_argument);
+  const int kTooLarge = static_cast<int>(std::errc::value_too_large);
+
+  for (std::string_view str : {"", "-", "0b", "12a3", "1 2", "0b102", "0x", "0x1g",
+                               "0o18", "0X12"}) {
+    ASSERT_EQ(error(str), kInvalid) << str;
+  }
+
+  ASSERT_EQ(*Int::FromString("18446744073709551615"), ~Int{});
+  ASSERT_EQ(*Int::FromString("00018'446'744'073'709'551'615"), ~Int{});
+  ASSERT_EQ(*Int::FromString("-0b" + std::string(64, '1')), -~Int{});
+  ASSERT_EQ(error("18446744073709551616"), kTooLarge);
+  ASSERT_EQ(error("99999999999999999999"), kTooLarge);
+  ASSERT_EQ(error("100000000000000000000"), kTooLarge);
+  ASSERT_EQ(error("0b1" + std::string(64, '0')), kTooLarge);
+  ASSERT_EQ(*Int::FromString("0x00FfffFFFF'FFFFffff"), ~Int{});
+  ASSERT_EQ(*Int::FromString("0o1" + std::string(21, '7')), ~Int{});
+  ASSERT_EQ(error("0x1" + std::string(16, '0')), kTooLarge);
+  ASSERT_EQ(error("0o2" + std::string(21, '0')), kTooLarge);
+  ASSERT_EQ(*Int::FromString("-00"), -Int{});
+}
+
 TEST_F(BigInt, DivShort) {
   using Int = algo::BigInt<8, uint8_t, uint16_t>;
 
@@ -352,6 +770,219 @@ TEST_F(BigInt, Div) {
   }
 }
 
+TEST_F(BigInt, DivLong) {
+  auto check = [](const auto& divident, const auto& divisor) {
+    auto quotient = divident / divisor;
+    auto remainder = divident % divisor;
+    ASSERT_EQ(quotient * divisor + remainder, divident)
+        << divident.ToString() << '\n'
+        << divisor.ToString();
+    ASSERT_LT(remainder, divisor);
+  };
+
+  SetSeed(2);
+  {
+    using Int = algo::BigInt<64, uint8_t, uint16_t>;
+
+    for (std::size_t i = 0; i < 1'000; ++i) {
+      std::size_t divident_len = RandomInt<std::size_t>(16, 256);
+      std::size_t divisor_len = RandomInt<std::size_t>(9, divident_len);
+      check(Int{RandomBinary(divident_len)}, Int{RandomBinary(divisor_len)});
+    }
+
+    // Divisors of form 2^k - 2^j and 2^k + 1 lead to quotient word
+    // overestimation and the add back step
+    Int one{1};
+    for (std::size_t k = 9; k < 120; k += 7) {
+      for (std::size_t j = 0; j < k; j += 5) {
+        Int divident = (one << 250) - (one << (k + 3)) - one;
+        check(divident, (one << k) - (one << j));
+        check(divident, (one << k) + one);
+      }
+    }
+  }
+
+  {
+    using Int = algo::BigInt<64, uint32_t, uint64_t>;
+
+    for (std::size_t i = 0; i < 300; ++i) {
+      std::size_t divident_len = RandomInt<std::size_t>(64, 2000);
+      std::size_t divisor_len = RandomInt<std::size_t>(33, divident_len);
+      check(Int{RandomBinary(divident_len)}, Int{RandomBinary(divisor_len)});
+    }
+  }
+}
+
+TEST_F(BigInt, DivRecursive) {
+  using Int = algo::BigInt<6000>;
+
+  auto random_words = [this](std::size_t min_size, std::size_t max_size) {
+    std::vector<uint32_t> words(RandomInt<std::size_t>(min_size, max_size));
+    for (uint32_t& word : words) {
+      word = RandomInt<uint32_t>();
+    }
+    words.back() |= 1;
+    return Int{words};
+  };
+
+  auto check = [](const Int& divident, const Int& divisor) {
+    Int quotient = divident / divisor;
+    Int remainder = divident % divisor;
+    ASSERT_EQ(quotient * divisor + remainder, divident);
+    ASSERT_LT(remainder, divisor);
+  };
+
+  SetSeed(3);
+  // Burnikel-Ziegler recursion
+  for (std::size_t i = 0; i < 10; ++i) {
+    Int divident = random_words(1'000, 3'000);
+    check(divident, random_words(450, divident.words_count - 450));
+  }
+
+  // Newton reciprocal, divisors close to B^n / 2 and B^n give
+  // extreme reciprocals
+  Int one{1};
+  for (std::size_t i = 0; i < 2; ++i) {
+    Int divident = random_words(5'500, 5'900);
+    Int divisor = random_words(1'000, 1'050);
+    std::size_t bits = divisor.BitWidth();
+    check(divident, divisor);
+    check(divident, (one << (bits - 1)) + random_words(1, 2));
+    check(divident, (one << bits) - random_words(1, 2));
+  }
+}
+
+TEST_F(BigInt, DivMod) {
+  using Int = algo::BigInt<8, uint8_t, uint16_t>;
+  Converter<Int> convert;
+
+  SetSeed(4);
+  for (std::size_t i = 0; i < 1'000; ++i) {
+    uint64_t divident = RandomInt<uint64_t>();
+    uint64_t divisor = RandomInt<uint64_t>(1, divident >> RandomInt(0, 63));
+    if (i % 4 == 0) {
+      // Powers of two are divided by shift and mask
+      divisor = uint64_t{1} << RandomInt(0, 63);
+    }
+
+    auto [quotient, remainder] = DivMod(convert(divident), convert(divisor));
+    ASSERT_EQ(quotient, convert(divident / divisor));
+    ASSERT_EQ(remainder, convert(divident % divisor));
+    ASSERT_EQ(convert(divident) % convert(divisor), remainder);
+  }
+
+  for (int lhs = -300; lhs <= 300; lhs += 7) {
+    for (int rhs : {-256, -17, -1, 1, 3, 16, 255, 1000}) {
+      Int lhs_int(std::abs(lhs), lhs >= 0);
+      Int rhs_int(std::abs(rhs), rhs >= 0);
+      auto [quotient, remainder] = DivMod(lhs_int, rhs_int);
+      ASSERT_EQ(quotient, lhs_int / rhs_int) << lhs << ' ' << rhs;
+      ASSERT_EQ(remainder, lhs_int % rhs_int) << lhs << ' ' << rhs;
+    }
+  }
+}
+
+TEST_F(BigInt, DivExact) {
+  auto check = [](auto lhs, const auto& rhs) {
+    auto product = lhs * rhs;
+    ASSERT_EQ(product.DivExact(rhs), lhs) << lhs << '\n' << rhs;
+  };
+
+  SetSeed(6);
+  {
+    using Int = algo::BigInt<64, uint8_t, uint16_t>;
+    for (std::size_t i = 0; i < 1'000; ++i) {
+      std::size_t lhs_len = RandomInt<std::size_t>(1, 256);
+      std::size_t rhs_len = RandomInt<std::size_t>(1, 500 - lhs_len);
+      Int lhs{RandomBinary(lhs_len)};
+      // Even divisors are shifted before Hensel division
+      Int rhs = Int{RandomBinary(rhs_len)} << RandomInt<std::size_t>(0, 9);
+      check(lhs, rhs);
+      check(-lhs, rhs);
+      check(lhs, -rhs);
+    }
+  }
+
+  {
+    using Int = algo::BigInt<300>;
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::size_t lhs_len = RandomInt<std::size_t>(1, 4'000);
+      std::size_t rhs_len = RandomInt<std::size_t>(1, 9'000 - lhs_len);
+      check(Int{RandomBinary(lhs_len)}, Int{RandomBinary(rhs_len)});
+    }
+
+    Int value{RandomBinary(1'000)};
+    ASSERT_EQ(value.DivExact(value), Int{1});
+    ASSERT_EQ(Int{}.DivExact(value), Int{});
+  }
+
+  {
+    // Quotient is split into halves
+    using Int = algo::BigInt<8200>;
+    auto random_words = [this](std::size_t size) {
+      std::vector<uint32_t> words(size);
+      for (uint32_t& word : words) {
+        word = RandomInt<uint32_t>();
+      }
+      words.back() |= 1;
+      return Int{words};
+    };
+
+    for (std::size_t i = 0; i < 3; ++i) {
+      check(random_words(RandomInt<std::size_t>(2'000, 5'000)),
+            random_words(RandomInt<std::size_t>(2'000, 3'000)));
+    }
+  }
+}
+
+TEST_F(BigInt, Divisor) {
+  auto check = [](const auto& divisor, const auto& divident) {
+    auto [quotient, remainder] = divisor.DivMod(divident);
+    ASSERT_EQ(quotient, divident / divisor.Divisor());
+    ASSERT_EQ(remainder, divident % divisor.Divisor());
+    ASSERT_EQ(divisor.Mod(divident), remainder);
+  };
+
+  SetSeed(5);
+  {
+    using Int = algo::BigInt<64, uint8_t, uint16_t>;
+    for (std::size_t i = 0; i < 200; ++i) {
+      std::size_t divisor_len = RandomInt<std::size_t>(1, 200);
+      algo::BigIntDivisor divisor{Int{RandomBinary(divisor_len)}};
+      for (std::size_t j = 0; j < 10; ++j) {
+        check(divisor, Int{RandomBinary(RandomInt<std::size_t>(1, 512))});
+      }
+      check(divisor, divisor.Divisor());
+      check(divisor, -divisor.Divisor());
+    }
+  }
+
+  {
+    // Long divisors, Burnikel-Ziegler division is used from 400 words,
+    // Barrett reduction from 1000 words
+    using Int = algo::BigInt<2400>;
+    auto random_words = [this](std::size_t size) {
+      std::vector<uint32_t> words(size);
+      for (uint32_t& word : words) {
+        word = RandomInt<uint32_t>();
+      }
+      words.back() |= 1;
+      return Int{words};
+    };
+
+    Int one{1};
+    for (std::size_t divisor_len : {100, 500, 1000, 1199}) {
+      for (Int value : {random_words(divisor_len),
+                        (one << (divisor_len * 32 - 1)) + one,
+                        (one << (divisor_len * 32)) - one}) {
+        algo::BigIntDivisor divisor{value};
+        check(divisor, random_words(RandomInt<std::size_t>(1, 2400)));
+        check(divisor, (value << (divisor_len * 32)) - one);
+      }
+    }
+  }
+}
+
 template<typename T>
 struct PowerModulo;
 
@@ -411,3 +1042,602 @@ TEST_F(BigInt, Algebra) {
     ASSERT_EQ(ret, Int{1}) << i << '\t' << n;
   }
 }
+
+TEST_F(BigInt, WordKernels) {
+  // Carry chains of kernels are compared with plain double word loops
+  using Kernel = algo::detail::BigIntKernel<uint64_t, algo::Uint128>;
+  constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+
+  SetSeed(8);
+  for (std::size_t n = 1; n < 40; ++n) {
+    std::vector<uint64_t> a(n), b(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      a[i] = i % 3 == 0 ? kMax : RandomInt<uint64_t>();
+      b[i] = i % 2 == 0 ? kMax : RandomInt<uint64_t>();
+    }
+    const uint64_t word = n % 2 == 0 ? kMax : RandomInt<uint64_t>();
+
+    std::vector<uint64_t> sum(n), diff(n), prod(n), addmul{b};
+    uint64_t carry = 0, borrow = 0, prod_high = 0, addmul_high = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      algo::Uint128 wide = algo::Uint128{a[i]} + b[i] + carry;
+      sum[i] = static_cast<uint64_t>(wide);
+      carry = static_cast<uint64_t>(wide >> 64);
+
+      wide = algo::Uint128{a[i]} - b[i] - borrow;
+      diff[i] = static_cast<uint64_t>(wide);
+      borrow = static_cast<uint64_t>(wide >> 64) & 1;
+
+      wide = algo::Uint128{a[i]} * word + prod_high;
+      prod[i] = static_cast<uint64_t>(wide);
+      prod_high = static_cast<uint64_t>(wide >> 64);
+
+      wide = algo::Uint128{a[i]} * word + addmul[i] + addmul_high;
+      addmul[i] = static_cast<uint64_t>(wide);
+      addmul_high = static_cast<uint64_t>(wide >> 64);
+    }
+
+    std::vector<uint64_t> r(n);
+    ASSERT_EQ(Kernel::AddN(r, a, b), carry != 0) << n;
+    ASSERT_EQ(r, sum) << n;
+    ASSERT_EQ(Kernel::SubN(r, a, b), borrow != 0) << n;
+    ASSERT_EQ(r, diff) << n;
+    ASSERT_EQ(Kernel::Mul1(r, a, word), prod_high) << n;
+    ASSERT_EQ(r, prod) << n;
+    r = b;
+    ASSERT_EQ(Kernel::AddMul1(r, a, word), addmul_high) << n;
+    ASSERT_EQ(r, addmul) << n;
+    // b - a word = r - borrow B^n, so adding product back gives b
+    r = b;
+    const uint64_t submul_borrow = Kernel::SubMul1(r, a, word);
+    ASSERT_EQ(Kernel::AddMul1(r, a, word), submul_borrow) << n;
+    ASSERT_EQ(r, b) << n;
+
+    // In place
+    r = a;
+    ASSERT_EQ(Kernel::Mul1(r, r, word), prod_high) << n;
+    ASSERT_EQ(r, prod) << n;
+  }
+}
+
+TEST_F(BigInt, Bitwise) {
+  // Operators are checked bit by bit on strings, values are long enough for
+  // vector loops and compared ones differ in a single bit
+  auto naive = [](std::string lhs, std::string rhs, auto op) {
+    const std::size_t size = std::max(lhs.size(), rhs.size());
+    lhs.insert(0, size - lhs.size(), '0');
+    rhs.insert(0, size - rhs.size(), '0');
+    std::string ret(size, '0');
+    for (std::size_t i = 0; i < size; ++i) {
+      ret[i] = op(lhs[i] == '1', rhs[i] == '1') ? '1' : '0';
+    }
+    ret.erase(0, std::min(ret.find('1'), size - 1));
+    return ret;
+  };
+
+  auto check = [&]<typename Int>(std::size_t bits) {
+    for (std::size_t i = 0; i < 100; ++i) {
+      std::string lhs = RandomBinary(RandomInt<std::size_t>(1, bits)).substr(2);
+      std::string rhs = RandomBinary(RandomInt<std::size_t>(1, bits)).substr(2);
+      const Int a{"0b" + lhs}, b{"0b" + rhs};
+      ASSERT_EQ((a & b).ToString(2), naive(lhs, rhs, std::bit_and{}));
+      ASSERT_EQ((a | b).ToString(2), naive(lhs, rhs, std::bit_or{}));
+      ASSERT_EQ((a ^ b).ToString(2), naive(lhs, rhs, std::bit_xor{}));
+      ASSERT_EQ((~a).ToString(2), naive(std::string(bits, '0'), lhs,
+                                        [](bool, bool x) { return !x; }));
+      ASSERT_EQ(~~a, a);
+      ASSERT_TRUE((a ^ a).IsZero());
+
+      const std::size_t bit = RandomInt<std::size_t>(0, lhs.size() - 1);
+      std::string flipped = lhs;
+      flipped[bit] = lhs[bit] == '0' ? '1' : '0';
+      const Int c{"0b" + flipped};
+      ASSERT_EQ(a <=> c, lhs[bit] <=> flipped[bit]);
+      ASSERT_EQ(a, Int{"0b" + lhs});
+      ASSERT_TRUE((a ^ c).IsPowerOf2());
+      ASSERT_FALSE((((a ^ c) >> 1) * Int{3}).IsPowerOf2());
+    }
+  };
+
+  SetSeed(12);
+  check.operator()<algo::BigInt<100>>(3'200);
+  check.operator()<algo::BigInt<50, uint64_t, algo::Uint128>>(3'200);
+}
+
+TEST_F(BigInt, Words64) {
+  // Results on 64 bit words are compared with ones on default 32 bit words.
+  // Sizes reach NTT multiplication, Burnikel-Ziegler division (n, k >= 400)
+  // and Newton one (n >= 1000, k >= 4n), where n and k are lengths of
+  // divisor and quotient
+  SetSeed(7);
+  CompareWithReference<algo::BigInt<6'200, uint64_t, algo::Uint128>,
+                       algo::BigInt<12'400>>({{1, 1},
+                                              {3, 1},
+                                              {40, 40},
+                                              {250, 100},
+                                              {500, 450},
+                                              {1'030, 1'030},
+                                              {1'500, 300},
+                                              {5'000, 1'030}});
+}
+
+TEST_F(BigInt, InfInt) {
+  // Results are compared with ones of capacity, which fits them all
+  using Fixed = algo::BigInt<6400>;
+  using algo::InfInt;
+
+  // Growing InfInt takes the same paths, up to Hensel split of exact
+  // division (2000 words)
+  SetSeed(13);
+  CompareWithReference<InfInt, Fixed>({{1, 1},
+                                       {2, 1},
+                                       {30, 20},
+                                       {300, 250},
+                                       {1'000, 600},
+                                       {2'500, 2'100},
+                                       {4'500, 1'050}});
+
+  // Moves take the buffer and leave zero behind
+  InfInt value = InfInt{1} << 100'000;
+  const uint32_t* data = value.binary.data();
+  InfInt moved{std::move(value)};
+  ASSERT_EQ(moved.binary.data(), data);
+  ASSERT_TRUE(value.IsZero());
+  value = std::move(moved);
+  ASSERT_EQ(value.binary.data(), data);
+  ASSERT_TRUE(moved.IsZero());
+
+  // Buffer grows geometrically, also when it is added to itself
+  InfInt power{1};
+  std::size_t reallocations = 0;
+  for (std::size_t i = 0; i < 100'000; ++i) {
+    data = power.binary.data();
+    power += power;
+    reallocations += data != power.binary.data() ? 1 : 0;
+  }
+  ASSERT_EQ(power, value);
+  ASSERT_LE(reallocations, 16);
+
+  power.Reserve(10'000);
+  ASSERT_GE(power.Capacity(), 10'000);
+  power.ShrinkToFit();
+  ASSERT_EQ(power.Capacity(), power.words_count);
+  ASSERT_EQ(Fixed{}.Capacity(), 6400);
+}
+
+TEST_F(BigInt, ShortNumbers) {
+  // Numbers of at most two words take fast paths and stay inline in InfInt,
+  // results are compared with 128 bit arithmetic
+  auto to_string = [](algo::Uint128 abs, bool is_positive) {
+    std::string ret;
+    do {
+      ret.push_back(static_cast<char>('0' + abs % 10));
+      abs /= 10;
+    } while (abs != 0);
+    if (!is_positive && ret != "0") {
+      ret.push_back('-');
+    }
+    std::reverse(ret.begin(), ret.end());
+    return ret;
+  };
+
+  auto check = [&]<typename Int>() {
+    for (std::size_t i = 0; i < 1'000; ++i) {
+      const uint64_t lhs_abs = RandomInt<uint64_t>() >> RandomInt(0, 63);
+      const uint64_t rhs_abs = RandomInt<uint64_t>() >> RandomInt(0, 63);
+      const bool lhs_sign = RandomInt(0, 1) == 0;
+      const bool rhs_sign = RandomInt(0, 1) == 0;
+      const Int lhs{lhs_abs, lhs_sign}, rhs{rhs_abs, rhs_sign};
+
+      // Sum of absolute values for equal signs, difference otherwise
+      auto add = [&](bool rhs_is_positive) {
+        if (lhs_sign == rhs_is_positive) {
+          return to_string(algo::Uint128{lhs_abs} + rhs_abs, lhs_sign);
+        } else if (lhs_abs >= rhs_abs) {
+          return to_string(lhs_abs - rhs_abs, lhs_sign);
+        }
+        return to_string(rhs_abs - lhs_abs, rhs_is_positive);
+      };
+      ASSERT_EQ((lhs + rhs).ToString(), add(rhs_sign));
+      ASSERT_EQ((lhs - rhs).ToString(), add(!rhs_sign));
+      ASSERT_EQ((lhs * rhs).ToString(),
+                to_string(algo::Uint128{lhs_abs} * rhs_abs,
+                          lhs_sign == rhs_sign));
+
+      auto value = [](uint64_t abs, bool is_positive) {
+        __extension__ using Int128 = __int128;
+        return is_positive ? Int128{abs} : -Int128{abs};
+      };
+      ASSERT_EQ(lhs <=> rhs,
+                value(lhs_abs, lhs_sign) <=> value(rhs_abs, rhs_sign));
+    }
+  };
+
+  SetSeed(14);
+  check.operator()<algo::InfInt>();
+  check.operator()<algo::BigInt<4>>();
+
+  // Inline words are enough for them
+  algo::InfInt counter;
+  for (uint64_t i = 0; i < 1'000; ++i) {
+    counter += algo::InfInt{i * i};
+  }
+  ASSERT_EQ(counter, algo::InfInt{332'833'500});
+  ASSERT_EQ(counter.Capacity(),
+            algo::detail::SmallWords<uint32_t>::kInlineWords);
+
+  // Growth out of inline words and of heap ones, also by the number itself,
+  // in constant evaluation
+  static_assert([] {
+    algo::InfInt inline_words = algo::InfInt{1} << 127;
+    inline_words += inline_words;
+    algo::InfInt heap_words = algo::InfInt{1} << 300;
+    algo::InfInt sum = heap_words;
+    sum += heap_words;
+    heap_words += heap_words;
+    return inline_words == algo::InfInt{1} << 128 && sum == heap_words &&
+           sum == algo::InfInt{1} << 301;
+  }());
+}
+
+TEST_F(BigInt, MemoryResource) {
+  using algo::InfInt;
+
+  // Monotonic arena, which counts allocations
+  struct Arena : std::pmr::memory_resource {
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+      ++allocations;
+      return upstream.allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes,
+                       std::size_t alignment) override {
+      upstream.deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    std::pmr::monotonic_buffer_resource upstream;
+    std::size_t allocations = 0;
+  };
+
+  SetSeed(15);
+  Arena arena;
+  const InfInt lhs_value{"0x1" + RandomString(799, "0123456789ABCDEF")};
+  const InfInt rhs_value{"0x1" + RandomString(479, "0123456789ABCDEF")};
+  InfInt lhs{arena};
+  InfInt rhs{arena};
+  lhs = lhs_value;
+  rhs = rhs_value;
+  ASSERT_EQ(lhs.Resource(), &arena);
+  ASSERT_EQ(lhs_value.Resource(), nullptr);
+
+  // Arena operations make no allocations by global operator new
+  auto global_allocations_of = [](auto&& operation) {
+    const std::size_t before = global_allocations;
+    operation();
+    return global_allocations - before;
+  };
+
+  // Results of free operators are copies of operands, so they are in arena
+  // together with scratch of Karatsuba multiplication and division
+  std::size_t allocations = arena.allocations;
+  InfInt product{arena};
+  ASSERT_EQ(global_allocations_of([&] { product = lhs * rhs; }), 0);
+  ASSERT_EQ(product.Resource(), &arena);
+  ASSERT_GT(arena.allocations, allocations + 2);
+  ASSERT_EQ(product, lhs_value * rhs_value);
+
+  allocations = arena.allocations;
+  InfInt quotient{arena};
+  ASSERT_EQ(global_allocations_of([&] { quotient = (product + rhs) / rhs; }),
+            0);
+  ASSERT_EQ(quotient.Resource(), &arena);
+  ASSERT_GT(arena.allocations, allocations + 2);
+  ASSERT_EQ(quotient, lhs_value + InfInt{1});
+
+  // Toom-Cook, NTT, Burnikel-Ziegler, Newton, Hensel and radix conversion
+  // temporaries are in arena too, results match the ones of default
+  // allocator. Only the string returned by ToString is allocated aside
+  for (auto [lhs_words, rhs_words] :
+       {std::pair{220, 220}, {1000, 450}, {5200, 1030}, {2100, 2100}}) {
+    const InfInt x{"0x1" + RandomString(8 * lhs_words - 1, "0123456789ABCDEF")};
+    const InfInt y{"0x1" + RandomString(8 * rhs_words - 1, "0123456789ABCDEF")};
+    const InfInt x_arena{x, arena};
+    const InfInt y_arena{y, arena};
+    const std::string x_string = x.ToString() + "'0";
+
+    InfInt xy{arena}, xy_quotient{arena}, exact{arena}, x_mod{arena};
+    std::pair div_mod{InfInt{arena}, InfInt{arena}};
+    std::pair divisor_div_mod{InfInt{arena}, InfInt{arena}};
+    std::string str;
+    std::optional<algo::Expected<InfInt>> parsed;
+    allocations = arena.allocations;
+    ASSERT_EQ(global_allocations_of([&] {
+                xy = x_arena * y_arena;
+                xy_quotient = x_arena / y_arena;
+                exact = xy;
+                exact.DivExact(y_arena);
+                div_mod = DivMod(x_arena, y_arena);
+
+                // Copy of divisor is explicitly put into arena
+                const algo::BigIntDivisor<-1ull> divisor{
+                    InfInt{y_arena, arena}};
+                x_mod = divisor.Mod(x_arena);
+                divisor_div_mod = divisor.DivMod(x_arena);
+
+                parsed = InfInt::FromString(x_string, arena);
+              }),
+              0);
+    ASSERT_LE(global_allocations_of([&] { str = x_arena.ToString(); }), 1);
+    ASSERT_GT(arena.allocations, allocations + 3);
+
+    ASSERT_EQ(xy, x * y);
+    ASSERT_EQ(xy.Resource(), &arena);
+    ASSERT_EQ(xy_quotient, x / y);
+    ASSERT_EQ(exact, x);
+    ASSERT_EQ(div_mod, DivMod(x, y));
+    ASSERT_EQ(div_mod.first.Resource(), &arena);
+    ASSERT_EQ(x_mod, x % y);
+    ASSERT_EQ(divisor_div_mod, div_mod);
+    ASSERT_EQ(divisor_div_mod.second.Resource(), &arena);
+    ASSERT_EQ(parsed->Value(), x * InfInt{10});
+    ASSERT_EQ(parsed->Value().Resource(), &arena);
+    ASSERT_EQ(str, x.ToString());
+  }
+
+  // Assignment keeps resource of destination
+  InfInt plain;
+  plain = product;
+  ASSERT_EQ(plain.Resource(), nullptr);
+  plain = std::move(quotient);
+  ASSERT_EQ(plain.Resource(), nullptr);
+  ASSERT_EQ(plain, lhs_value + InfInt{1});
+
+  InfInt copy{plain, arena};
+  ASSERT_EQ(copy.Resource(), &arena);
+  ASSERT_EQ(copy, plain);
+  InfInt moved{std::move(copy)};
+  ASSERT_EQ(moved.Resource(), &arena);
+  ASSERT_EQ(moved, plain);
+
+  // Copy construction doesn't keep resource, so the copy outlives arena
+  std::optional<InfInt> kept;
+  {
+    Arena scoped;
+    const InfInt value{lhs_value, scoped};
+    kept.emplace(value);
+    ASSERT_EQ(kept->Resource(), nullptr);
+    ASSERT_EQ((value + rhs_value).Resource(), &scoped);
+    ASSERT_EQ((-value).Resource(), &scoped);
+    ASSERT_EQ((rhs_value - value).Resource(), nullptr);
+  }
+  ASSERT_EQ(*kept, lhs_value);
+}
+
+TEST_F(BigInt, CopyOnWrite) {
+  using algo::InfInt;
+
+  SetSeed(16);
+  const std::string hex = "0x1" + RandomString(7'999, "0123456789ABCDEF");
+  const InfInt value{hex};
+  const InfInt divisor{"0x1" + RandomString(2'999, "0123456789ABCDEF")};
+
+  // Copies share words, each operation changes only its copy. Results are
+  // compared with ones of values parsed anew
+  std::vector<std::function<void(InfInt&)>> operations{
+      [&](InfInt& x) { x += divisor; },
+      [&](InfInt& x) { x -= divisor; },
+      [&](InfInt& x) { x += x; },
+      [&](InfInt& x) { x -= InfInt{hex}; },
+      [&](InfInt& x) { x *= divisor; },
+      [&](InfInt& x) { x.Square(); },
+      [&](InfInt& x) { x /= divisor; },
+      [&](InfInt& x) { x %= divisor; },
+      [&](InfInt& x) { x /= InfInt{1} << 100; },
+      [&](InfInt& x) { x %= InfInt{1} << 100; },
+      [&](InfInt& x) { x /= InfInt{7}; },
+      [&](InfInt& x) { x *= InfInt{7}; },
+      [&](InfInt& x) { x.DivExact(InfInt{1}); },
+      [&](InfInt& x) { x <<= 33; },
+      [&](InfInt& x) { x >>= 33; },
+      [&](InfInt& x) { x >>= 1'000'000; },
+      [&](InfInt& x) { x ^= divisor; },
+      [&](InfInt& x) { x |= divisor; },
+      [&](InfInt& x) { x &= divisor; },
+      [&](InfInt& x) { x = -x; },
+  };
+  for (const auto& operation : operations) {
+    InfInt copy = value;
+    ASSERT_EQ(std::as_const(copy).binary.data(), value.binary.data());
+    InfInt expected{hex};
+    operation(copy);
+    operation(expected);
+    ASSERT_EQ(copy, expected);
+    ASSERT_EQ(value, InfInt{hex});
+  }
+
+  // Words written from outside are copied first as well
+  InfInt copy = value;
+  copy.binary[0] ^= 1;
+  ASSERT_NE(copy, value);
+  ASSERT_EQ(value, InfInt{hex});
+
+  // Sharing is safe between threads
+  std::atomic<std::size_t> mismatches = 0;
+  algo::ThreadPool<std::function<void()>> pool(4, 100);
+  pool.Start();
+  for (std::size_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(pool.Enqueue([&mismatches, &divisor, copy = value]() mutable {
+      InfInt shared = copy;
+      copy += divisor;
+      if (copy - divisor != shared) {
+        mismatches += 1;
+      }
+    }));
+  }
+  pool.Stop();
+  ASSERT_EQ(mismatches, 0);
+  ASSERT_EQ(value, InfInt{hex});
+
+  // Constant evaluation copies heap words instead of sharing them
+  static_assert([] {
+    InfInt x = InfInt{1} << 300;
+    InfInt copy = x;
+    copy <<= 1;
+    return copy == x * InfInt{2} && x == InfInt{1} << 300;
+  }());
+}
+
+TEST_F(BigInt, Lazy) {
+  // Lazy sums of products are compared with eager ones
+  SetSeed(17);
+  ForProductSizes([]<typename Int>(auto random) {
+    for (std::size_t i = 0; i < 50; ++i) {
+      const Int a = random(), b = random(), c = random(), d = random();
+      const Int e = random();
+      Int x = random();
+      const Int x_value = x;
+
+      Int sum = algo::Lazy(a) * b + algo::Lazy(c) * d - e;
+      ASSERT_EQ(sum, a * b + c * d - e);
+      sum = e - algo::Lazy(a) * b;
+      ASSERT_EQ(sum, e - a * b);
+      sum -= algo::Lazy(c) * d + a;
+      ASSERT_EQ(sum, e - a * b - c * d - a);
+      ASSERT_EQ(Int{a * algo::Lazy(b)}, a * b);
+      ASSERT_EQ(Int{-algo::Lazy(a) * b}, -(a * b));
+
+      // Third factor is multiplied eagerly
+      sum = algo::Lazy(a) * b * c;
+      ASSERT_EQ(sum, a * b * c);
+      sum = d * (a * algo::Lazy(b)) + e;
+      ASSERT_EQ(sum, d * (a * b) + e);
+
+      // Destination may be an operand
+      x = algo::Lazy(x) * b + x;
+      ASSERT_EQ(x, x_value * b + x_value);
+      x += algo::Lazy(x) * c;
+      ASSERT_EQ(x, (x_value * b + x_value) * (c + Int{1}));
+      sum = algo::Lazy(a) * a - algo::Lazy(a) * a;
+      ASSERT_EQ(sum, Int{});
+      ASSERT_TRUE(sum.is_positive);
+    }
+  });
+
+  const algo::BigInt<8> two{2}, three{3}, five{5};
+  ASSERT_EQ(algo::BigInt<8>{algo::Lazy(two) * three * five},
+            algo::BigInt<8>{30});
+
+  // Words of destination are reused
+  const algo::InfInt a{"0x1" + RandomString(79, "0123456789ABCDEF")};
+  algo::InfInt sum = a * a * a;
+  const auto* data = sum.binary.data();
+  sum = algo::Lazy(a) * a + algo::Lazy(a) * a;
+  ASSERT_EQ(sum.binary.data(), data);
+  ASSERT_EQ(sum, a * a + a * a);
+}
+
+TEST_F(BigInt, AddMul) {
+  // Fused operations are compared with eager ones
+  SetSeed(18);
+  ForProductSizes([this]<typename Int>(auto random) {
+    using Word = std::remove_cvref_t<decltype(Int{}.binary[0])>;
+    for (std::size_t i = 0; i < 100; ++i) {
+      const Int x = random(), y = random();
+      const Word word = RandomInt<Word>();
+      Int acc = random();
+      const Int value = acc;
+
+      AddMul(acc, x, y);
+      ASSERT_EQ(acc, value + x * y);
+      SubMul(acc, x, y);
+      ASSERT_EQ(acc, value);
+      SubMul(acc, x, y);
+      ASSERT_EQ(acc, value - x * y);
+      AddMulWord(acc, x, word);
+      ASSERT_EQ(acc, value - x * y + x * Int{word});
+      SubMulWord(acc, x, word);
+      ASSERT_EQ(acc, value - x * y);
+
+      // Result crosses zero, or is zero
+      acc = x * y + Int{1};
+      SubMul(acc, x, y);
+      ASSERT_EQ(acc, Int{1});
+      SubMul(acc, x, y);
+      ASSERT_EQ(acc, Int{1} - x * y);
+      acc = -(x * Int{word});
+      AddMulWord(acc, x, word);
+      ASSERT_TRUE(acc.IsZero() && acc.is_positive);
+
+      // Operand may be acc
+      acc = value;
+      AddMul(acc, acc, y);
+      ASSERT_EQ(acc, value + value * y);
+      acc = value;
+      SubMulWord(acc, acc, word);
+      ASSERT_EQ(acc, value - value * Int{word});
+    }
+  });
+
+  // Words of operands don't fit in capacity, while their product does
+  using Small = algo::BigInt<4>;
+  const Small max{"0x" + std::string(32, 'F')};
+  const Small x{"0x1" + std::string(16, '0')}, y{"0x1" + std::string(8, '0')};
+  Small acc = -max;
+  AddMul(acc, x, y);
+  ASSERT_EQ(acc, (Small{1} << 96) - max);
+  SubMul(acc, y, x);
+  ASSERT_EQ(acc, -max);
+}
+
+TEST_F(BigInt, MixedCapacity) {
+  // Results are compared with ones of operands converted to capacity, which
+  // fits them all
+  using Narrow = algo::BigInt<4>;
+  using Wide = algo::BigInt<12>;
+  using Full = algo::BigInt<16>;
+  using algo::InfInt;
+
+  auto full = [](const auto& value) {
+    return Full{value.ToView(), value.is_positive};
+  };
+
+  SetSeed(19);
+  for (std::size_t i = 0; i < 1'000; ++i) {
+    const auto x = RandomSigned<Narrow>(4);
+    const auto y = RandomSigned<Wide>(8);
+    const auto m = RandomSigned<Narrow>(4);
+
+    const auto product = MulWide(x, y);
+    static_assert(std::is_same_v<decltype(product), const Full>);
+    ASSERT_EQ(product, full(x) * full(y));
+    ASSERT_EQ(full(MulWide(x, x)), full(x) * full(x));
+
+    // Reduction of product by modulo of narrow capacity
+    const auto remainder = MulWide(x, x) % m;
+    static_assert(std::is_same_v<decltype(remainder), const Narrow>);
+    ASSERT_EQ(full(remainder), full(x) * full(x) % full(m));
+    ASSERT_EQ(full(x % y), full(x) % full(y));
+
+    ASSERT_EQ(full(x + y), full(x) + full(y));
+    ASSERT_EQ(full(y + x), full(x) + full(y));
+    ASSERT_EQ(full(x - y), full(x) - full(y));
+    ASSERT_EQ(full(y - x), full(y) - full(x));
+
+    Wide acc = y;
+    acc += x;
+    acc -= m;
+    ASSERT_EQ(full(acc), full(y) + full(x) - full(m));
+    acc %= m;
+    ASSERT_EQ(full(acc), (full(y) + full(x) - full(m)) % full(m));
+  }
+
+  // Capacity of product with InfInt is unbounded
+  const auto x = RandomSigned<Narrow>(4);
+  const InfInt y{"0x1" + RandomString(999, "0123456789ABCDEF")};
+  const auto product = MulWide(x, y);
+  static_assert(std::is_same_v<decltype(product), const InfInt>);
+  ASSERT_EQ(product, (InfInt{x.ToView(), x.is_positive} * y));
+  ASSERT_EQ(product % x, Narrow{});
+}